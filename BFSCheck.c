@@ -0,0 +1,703 @@
+#define _POSIX_C_SOURCE 200809L
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<time.h>
+#include<unistd.h>
+#include"Graph.h"
+#include"GraphVariants.h"
+#include"Sketch.h"
+#include"DistBFS.h"
+#include"ExtBFS.h"
+
+// Differential tester for the BFS engines. Every round builds a random graph
+// in every form the engines take, runs the same random queries through each
+// of them, and checks the answers against a plain queue-based BFS of its own:
+// the distances must be the same, every path must be a shortest path in the
+// graph, and the engines that promise to find the same BFS tree as BFS()
+// must return the very same path as getPath().
+
+// What an engine promises about the paths it returns
+#define PATH_NONE 0
+#define PATH_SHORTEST 1
+#define PATH_SAME 2
+
+// Landmarks of the Sketch, neighbors held by the cache of the ExtGraph
+// searched with extBFSTo(), and worker processes of the DistGraph
+#define LANDMARKS 4
+#define EXT_CACHE 64
+#define DIST_PROCS 2
+
+// Most mismatches printed in full
+#define REPORT_LIMIT 10
+
+// structs --------------------------------------------------------------------
+
+// A random graph of order n with m edges edge[2i] edge[2i+1], which are
+// arcs if directed is true, and the graph kept in every form the engines
+// search: the adjacency lists of the reference BFS in CSR form, and one
+// object per engine that can search a graph of this kind, or NULL
+typedef struct Check {
+    int order;
+    long size;
+    int directed;
+    int* edge;
+    long* offset;
+    int* target;
+    int* dist;
+    int* queue;
+    Graph graph;
+    Search search;
+    Graph bulk;
+    Graph packed;
+    Graph dedup;
+    Graph weighted;
+    HopGraph hop;
+    ArcGraph arc;
+    BigGraph big;
+    ExtGraph ext;
+    ExtGraph cached;
+    ExtGraph mixed;
+    int mixedSource;
+    int mixedFull;
+    DistGraph split;
+    Sketch sketch;
+    char* extPath;
+    char* distPath;
+    int procs;
+} Check;
+
+// Finds a path from s to t with one engine, appending it to L, and returns
+// its length, INF if there is none, or -2 if the engine can't tell
+typedef int (*Solve)(Check* C, int s, int t, List L);
+
+// An engine, whether it can search directed graphs, what it promises about
+// its paths, and its tally so far
+typedef struct Engine {
+    char* name;
+    int directed;
+    int paths;
+    Solve solve;
+    long checked;
+    long skipped;
+    long failed;
+    double seconds;
+} Engine;
+
+// Random number generator ----------------------------------------------------
+
+static uint64_t seed = 1;
+
+// Returns the next number of a splitmix64 sequence
+uint64_t nextRandom(void) {
+    uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return(z ^ (z >> 31));
+}
+
+// Returns a random number from 0 to k-1
+int randomBelow(int k) {
+    return((int)(nextRandom() % (uint64_t)k));
+}
+
+// Returns the seconds on a monotonic clock
+double now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return(t.tv_sec + t.tv_nsec*1e-9);
+}
+
+// Reference BFS --------------------------------------------------------------
+
+// Sets C->dist to the distances from s, following the adjacency lists of
+// C in CSR form with a plain queue
+void referenceBFS(Check* C, int s) {
+    int head = 0, tail = 0;
+    for(int v=1; v<C->order+1; v++) {
+        C->dist[v] = INF;
+    }
+    C->dist[s] = 0;
+    C->queue[tail++] = s;
+    while(head < tail) {
+        int u = C->queue[head++];
+        for(long i=C->offset[u]; i<C->offset[u+1]; i++) {
+            int v = C->target[i];
+            if(C->dist[v] == INF) {
+                C->dist[v] = C->dist[u] + 1;
+                C->queue[tail++] = v;
+            }
+        }
+    }
+}
+
+// Returns true (1) if C has an arc from u to v, or an edge joining them
+int hasArc(Check* C, int u, int v) {
+    for(long i=C->offset[u]; i<C->offset[u+1]; i++) {
+        if(C->target[i] == v) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Engines --------------------------------------------------------------------
+
+// BFS() and getPath(), the behavior every other engine is held to
+int solveGraph(Check* C, int s, int t, List L) {
+    BFS(C->graph, s);
+    getPath(L, C->graph, t);
+    return(getDist(C->graph, t));
+}
+
+// searchBFS() on a Search of its own
+int solveSearch(Check* C, int s, int t, List L) {
+    searchBFS(C->search, s);
+    searchPath(L, C->search, t);
+    return(searchDist(C->search, t));
+}
+
+// searchVisit() stopped as soon as t is found, as FindPath runs it
+int solveVisit(Check* C, int s, int t, List L) {
+    searchVisit(C->search, s, -1, stopAtVertex, NULL, &t);
+    searchPath(L, C->search, t);
+    return(searchDist(C->search, t));
+}
+
+// searchDepth() with a limit no path reaches
+int solveDepth(Check* C, int s, int t, List L) {
+    searchDepth(C->search, s, C->order);
+    searchPath(L, C->search, t);
+    return(searchDist(C->search, t));
+}
+
+// Bidirectional BFS
+int solveBetween(Check* C, int s, int t, List L) {
+    return(searchBetween(C->search, s, t, L));
+}
+
+// BFS backwards from t, whose path runs from t back to s
+int solveReverse(Check* C, int s, int t, List L) {
+    searchReverse(C->search, t);
+    int d = searchDist(C->search, s);
+    if(d == INF) {
+        append(L, NIL);
+        return(INF);
+    }
+    int* P = malloc((d+1) * sizeof(int));
+    List R = newList();
+    searchPath(R, C->search, s);
+    toArray(R, P);
+    for(int i=d; i>=0; i--) {
+        append(L, P[i]);
+    }
+    freeList(&R);
+    free(P);
+    return(d);
+}
+
+// BFS() over a Graph filled all at once by addEdges()
+int solveBulk(Check* C, int s, int t, List L) {
+    BFS(C->bulk, s);
+    getPath(L, C->bulk, t);
+    return(getDist(C->bulk, t));
+}
+
+// BFS() over a compressed Graph
+int solvePacked(Check* C, int s, int t, List L) {
+    BFS(C->packed, s);
+    getPath(L, C->packed, t);
+    return(getDist(C->packed, t));
+}
+
+// BFS() over a Graph that dropped duplicate edges and self-loops
+int solveDedup(Check* C, int s, int t, List L) {
+    BFS(C->dedup, s);
+    getPath(L, C->dedup, t);
+    return(getDist(C->dedup, t));
+}
+
+// shortestPaths() over the Graph with every weight 1
+int solveWeighted(Check* C, int s, int t, List L) {
+    shortestPaths(C->weighted, s);
+    getPath(L, C->weighted, t);
+    return(getDist(C->weighted, t));
+}
+
+// The distance-only HopGraph variant, which has no paths to give
+int solveHop(Check* C, int s, int t, List L) {
+    (void)L;
+    hopGraphBFS(C->hop, s);
+    uint32_t d = hopGraphDist(C->hop, t);
+    return(d==GRAPH_INF(uint32_t) ? INF : (int)d);
+}
+
+// The directed ArcGraph variant, given an undirected graph as arcs both ways
+int solveArc(Check* C, int s, int t, List L) {
+    arcGraphBFS(C->arc, s);
+    uint32_t d = arcGraphDist(C->arc, t);
+    if(d == GRAPH_INF(uint32_t)) {
+        append(L, NIL);
+        return(INF);
+    }
+    uint32_t* P = malloc((d+1) * sizeof(uint32_t));
+    arcGraphPath(C->arc, t, P);
+    for(uint32_t i=0; i<d+1; i++) {
+        append(L, (int)P[i]);
+    }
+    free(P);
+    return((int)d);
+}
+
+// The 64-bit BigGraph variant
+int solveBig(Check* C, int s, int t, List L) {
+    bigGraphBFS(C->big, s);
+    uint64_t d = bigGraphDist(C->big, t);
+    if(d == GRAPH_INF(uint64_t)) {
+        append(L, NIL);
+        return(INF);
+    }
+    uint64_t* P = malloc((d+1) * sizeof(uint64_t));
+    bigGraphPath(C->big, t, P);
+    for(uint64_t i=0; i<d+1; i++) {
+        append(L, (int)P[i]);
+    }
+    free(P);
+    return((int)d);
+}
+
+// extBFS() over the adjacency file written by writeAdjacencyFile()
+int solveExt(Check* C, int s, int t, List L) {
+    extBFS(C->ext, s);
+    extPath(L, C->ext, t);
+    return(extDist(C->ext, t));
+}
+
+// extBFSTo() through a cache far smaller than the graph
+int solveCached(Check* C, int s, int t, List L) {
+    extBFSTo(C->cached, s, t);
+    extPath(L, C->cached, t);
+    return(extDist(C->cached, t));
+}
+
+// extBFSTo() over an ExtGraph that extBFS() also searches from every other
+// source, so that each has to start over after a search by the other
+int solveMixed(Check* C, int s, int t, List L) {
+    if(s != C->mixedSource) {
+        C->mixedSource = s;
+        C->mixedFull = !C->mixedFull;
+        if(C->mixedFull) {
+            extBFS(C->mixed, s);
+        }
+    }
+    extBFSTo(C->mixed, s, t);
+    extPath(L, C->mixed, t);
+    return(extDist(C->mixed, t));
+}
+
+// distBFS() over worker processes
+int solveSplit(Check* C, int s, int t, List L) {
+    distBFS(C->split, s);
+    distPath(L, C->split, t);
+    return(distDist(C->split, t));
+}
+
+// The landmark sketch, which only answers when its bounds meet, or when
+// they show there is no path
+int solveSketch(Check* C, int s, int t, List L) {
+    int d = sketchPath(C->sketch, C->search, s, t, L);
+    return(d==SKETCH_UNKNOWN ? -2 : d);
+}
+
+static Engine engines[] = {
+    { "BFS",      1, PATH_SAME,     solveGraph,    0, 0, 0, 0 },
+    { "search",   1, PATH_SAME,     solveSearch,   0, 0, 0, 0 },
+    { "visit",    1, PATH_SAME,     solveVisit,    0, 0, 0, 0 },
+    { "depth",    1, PATH_SAME,     solveDepth,    0, 0, 0, 0 },
+    { "between",  1, PATH_SHORTEST, solveBetween,  0, 0, 0, 0 },
+    { "reverse",  1, PATH_SHORTEST, solveReverse,  0, 0, 0, 0 },
+    { "bulk",     0, PATH_SAME,     solveBulk,     0, 0, 0, 0 },
+    { "packed",   1, PATH_SAME,     solvePacked,   0, 0, 0, 0 },
+    { "dedup",    1, PATH_SAME,     solveDedup,    0, 0, 0, 0 },
+    { "weighted", 1, PATH_SHORTEST, solveWeighted, 0, 0, 0, 0 },
+    { "hop",      0, PATH_NONE,     solveHop,      0, 0, 0, 0 },
+    { "arc",      1, PATH_SAME,     solveArc,      0, 0, 0, 0 },
+    { "big",      0, PATH_SAME,     solveBig,      0, 0, 0, 0 },
+    { "ext",      1, PATH_SAME,     solveExt,      0, 0, 0, 0 },
+    { "cached",   1, PATH_SAME,     solveCached,   0, 0, 0, 0 },
+    { "mixed",    1, PATH_SAME,     solveMixed,    0, 0, 0, 0 },
+    { "split",    0, PATH_SAME,     solveSplit,    0, 0, 0, 0 },
+    { "sketch",   1, PATH_SHORTEST, solveSketch,   0, 0, 0, 0 },
+};
+
+#define ENGINES ((int)(sizeof(engines) / sizeof(engines[0])))
+
+// Building the graphs --------------------------------------------------------
+
+// Fills C with a random graph of order n of the given family: sparse, with
+// many small components, dense, or a long chain with a few shortcuts. Some
+// edges are repeated and some are self-loops, for dedup to drop.
+void randomGraph(Check* C, int n, int family, int directed) {
+    long m = family==0 ? n/2 : family==1 ? 3L*n : n-1 + n/16;
+    C->order = n;
+    C->size = m;
+    C->directed = directed;
+    C->edge = malloc((2*m+2) * sizeof(int));
+    for(long i=0; i<m; i++) {
+        int u, v;
+        if(family==2 && i<n-1) {
+            u = i+1;
+            v = i+2;
+        } else if(i>0 && randomBelow(16)==0) {
+            long j = randomBelow(i);
+            u = C->edge[2*j];
+            v = C->edge[2*j+1];
+        } else {
+            u = randomBelow(n) + 1;
+            v = randomBelow(16)==0 ? u : randomBelow(n) + 1;
+        }
+        C->edge[2*i] = u;
+        C->edge[2*i+1] = v;
+    }
+}
+
+// Writes the graph of C in the input format of FindPath to C->distPath
+void writeInput(Check* C) {
+    FILE* f = fopen(C->distPath, "w");
+    if(f == NULL) {
+        printf("Unable to open file %s for writing\n", C->distPath);
+        exit(1);
+    }
+    fprintf(f, "%d\n", C->order);
+    for(long i=0; i<C->size; i++) {
+        fprintf(f, "%d %d\n", C->edge[2*i], C->edge[2*i+1]);
+    }
+    fprintf(f, "0 0\n0 0\n");
+    if(fclose(f) != 0) {
+        printf("Unable to write file %s\n", C->distPath);
+        exit(1);
+    }
+}
+
+// Builds every form of the graph of C that its engines search
+void buildCheck(Check* C) {
+    int n = C->order;
+    long m = C->size;
+
+    // The reference adjacency lists, in CSR form
+    C->offset = calloc(n+2, sizeof(long));
+    C->target = malloc((2*m+1) * sizeof(int));
+    C->dist = malloc((n+1) * sizeof(int));
+    C->queue = malloc((n+1) * sizeof(int));
+    for(long i=0; i<m; i++) {
+        C->offset[C->edge[2*i]+1]++;
+        if(!C->directed) {
+            C->offset[C->edge[2*i+1]+1]++;
+        }
+    }
+    for(int v=1; v<n+1; v++) {
+        C->offset[v+1] += C->offset[v];
+    }
+    long* fill = malloc((n+2) * sizeof(long));
+    memcpy(fill, C->offset, (n+2) * sizeof(long));
+    for(long i=0; i<m; i++) {
+        int u = C->edge[2*i], v = C->edge[2*i+1];
+        C->target[fill[u]++] = v;
+        if(!C->directed) {
+            C->target[fill[v]++] = u;
+        }
+    }
+    free(fill);
+
+    // The Graphs, built one edge at a time or all at once
+    C->graph = newGraph(n);
+    C->packed = newGraph(n);
+    C->dedup = newGraph(n);
+    C->weighted = newGraph(n);
+    setDedup(C->dedup, 1);
+    for(long i=0; i<m; i++) {
+        int u = C->edge[2*i], v = C->edge[2*i+1];
+        if(C->directed) {
+            addArc(C->graph, u, v);
+            addArc(C->packed, u, v);
+            addArc(C->dedup, u, v);
+            addWeightedArc(C->weighted, u, v, 1);
+        } else {
+            addEdge(C->graph, u, v);
+            addEdge(C->packed, u, v);
+            addEdge(C->dedup, u, v);
+            addWeightedEdge(C->weighted, u, v, 1);
+        }
+    }
+    compressGraph(C->packed);
+    C->search = newSearch(C->graph);
+    C->bulk = NULL;
+    if(!C->directed) {
+        C->bulk = newGraph(n);
+        addEdges(C->bulk, C->edge, NULL, m);
+    }
+
+    // The variants, the directed one given every edge as arcs both ways
+    uint32_t* E32 = malloc((4*m+2) * sizeof(uint32_t));
+    uint64_t* E64 = malloc((2*m+2) * sizeof(uint64_t));
+    long arcs = 0;
+    for(long i=0; i<m; i++) {
+        E64[2*i] = C->edge[2*i];
+        E64[2*i+1] = C->edge[2*i+1];
+        E32[2*arcs] = C->edge[2*i];
+        E32[2*arcs+1] = C->edge[2*i+1];
+        arcs++;
+        if(!C->directed) {
+            E32[2*arcs] = C->edge[2*i+1];
+            E32[2*arcs+1] = C->edge[2*i];
+            arcs++;
+        }
+    }
+    C->arc = newArcGraph(n, E32, arcs, ALLOC_DEFAULT);
+    C->hop = NULL;
+    C->big = NULL;
+    if(!C->directed) {
+        for(long i=0; i<2*m; i++) {
+            E32[i] = C->edge[i];
+        }
+        C->hop = newHopGraph(n, E32, m, ALLOC_DEFAULT);
+        C->big = newBigGraph(n, E64, m, ALLOC_DEFAULT);
+    }
+    free(E32);
+    free(E64);
+
+    // The graph on disk, and split over worker processes
+    writeAdjacencyFile(C->graph, C->extPath, NULL);
+    C->ext = openExtGraph(C->extPath);
+    C->cached = openExtGraph(C->extPath);
+    C->mixed = openExtGraph(C->extPath);
+    if(C->ext==NULL || C->cached==NULL || C->mixed==NULL) {
+        printf("Unable to read file %s\n", C->extPath);
+        exit(1);
+    }
+    setExtCache(C->cached, EXT_CACHE);
+    C->mixedSource = NIL;
+    C->mixedFull = 0;
+    C->split = NULL;
+    if(!C->directed && C->procs>0) {
+        writeInput(C);
+        C->split = newDistGraph(C->distPath, C->procs, ALLOC_DEFAULT);
+    }
+
+    C->sketch = newSketch(C->graph, LANDMARKS, 1);
+}
+
+// Frees everything built by randomGraph() and buildCheck()
+void freeCheck(Check* C) {
+    freeSketch(&C->sketch);
+    if(C->split != NULL) {
+        freeDistGraph(&C->split);
+    }
+    freeExtGraph(&C->ext);
+    freeExtGraph(&C->cached);
+    freeExtGraph(&C->mixed);
+    freeArcGraph(&C->arc);
+    if(C->hop != NULL) {
+        freeHopGraph(&C->hop);
+        freeBigGraph(&C->big);
+    }
+    if(C->bulk != NULL) {
+        freeGraph(&C->bulk);
+    }
+    freeSearch(&C->search);
+    freeGraph(&C->graph);
+    freeGraph(&C->packed);
+    freeGraph(&C->dedup);
+    freeGraph(&C->weighted);
+    free(C->edge);
+    free(C->offset);
+    free(C->target);
+    free(C->dist);
+    free(C->queue);
+}
+
+// Checking the answers -------------------------------------------------------
+
+// Prints a mismatch of engine X on the query from s to t, unless too many
+// have been printed already, and counts it
+void mismatch(Engine* X, Check* C, int s, int t, char* what) {
+    static int reported = 0;
+    X->failed++;
+    if(reported++ < REPORT_LIMIT) {
+        printf("%s: %s from %d to %d in a graph of order %d with %ld %s\n",
+               X->name, what, s, t, C->order, C->size, C->directed ? "arcs" : "edges");
+    }
+}
+
+// Runs the query from s to t through every engine that can search C, and
+// checks each answer against the reference distances from s, which must
+// already be in C->dist, and the path of BFS() in P
+void checkQuery(Check* C, int s, int t, List L, int* P, int* Q) {
+    int expect = C->dist[t];
+    int refLength = 0;
+
+    for(int x=0; x<ENGINES; x++) {
+        Engine* X = &engines[x];
+        if(C->directed && !X->directed) {
+            continue;
+        }
+        if(X->solve==solveSplit && C->split==NULL) {
+            continue;
+        }
+        clear(L);
+        double start = now();
+        int d = X->solve(C, s, t, L);
+        X->seconds += now() - start;
+        if(d == -2) {
+            X->skipped++;
+            continue;
+        }
+        X->checked++;
+
+        if(d != expect) {
+            mismatch(X, C, s, t, "wrong distance");
+            continue;
+        }
+        if(X->paths == PATH_NONE) {
+            continue;
+        }
+
+        // The path must be NIL alone if there is none, otherwise a walk
+        // along arcs of the graph from s to t one longer than the distance
+        int k = length(L);
+        if(expect == INF) {
+            if(k!=1 || front(L)!=NIL) {
+                mismatch(X, C, s, t, "path where there is none");
+            }
+            continue;
+        }
+        if(k != expect+1) {
+            mismatch(X, C, s, t, "path of the wrong length");
+            continue;
+        }
+        toArray(L, Q);
+        int ok = Q[0]==s && Q[k-1]==t;
+        for(int i=0; ok && i<k-1; i++) {
+            ok = hasArc(C, Q[i], Q[i+1]);
+        }
+        if(!ok) {
+            mismatch(X, C, s, t, "path that isn't in the graph");
+            continue;
+        }
+
+        // BFS() comes first and sets the path the others must match
+        if(X == &engines[0]) {
+            memcpy(P, Q, k * sizeof(int));
+            refLength = k;
+        } else if(X->paths==PATH_SAME && (k!=refLength || memcmp(P, Q, k * sizeof(int))!=0)) {
+            mismatch(X, C, s, t, "path other than that of BFS()");
+        }
+    }
+}
+
+// Runs q random queries over C, several from each source so that
+// extBFSTo() gets to carry on from where it stopped, and checks them
+void checkQueries(Check* C, int q, int* searches, double* reference) {
+    List L = newList();
+    int* P = malloc((C->order+1) * sizeof(int));
+    int* Q = malloc((C->order+1) * sizeof(int));
+    int s = 1;
+    for(int i=0; i<q; i++) {
+        if(i==0 || randomBelow(4)==0) {
+            s = randomBelow(C->order) + 1;
+            double start = now();
+            referenceBFS(C, s);
+            *reference += now() - start;
+            (*searches)++;
+        }
+        checkQuery(C, s, randomBelow(C->order) + 1, L, P, Q);
+    }
+    free(P);
+    free(Q);
+    freeList(&L);
+}
+
+// Prints the tally of every engine, with the queries each answered per
+// second, and the searches per second of the reference BFS, which runs
+// once per source. Returns the number of mismatches found.
+long printTally(int searches, double reference) {
+    long failed = 0;
+    printf("%-10s %10s %10s %10s %12s\n", "engine", "checked", "skipped", "failed", "queries/s");
+    printf("%-10s %10d %10s %10s %12.0f\n", "reference", searches, "-", "-", reference>0 ? searches/reference : 0);
+    for(int x=0; x<ENGINES; x++) {
+        Engine* X = &engines[x];
+        long ran = X->checked + X->skipped;
+        printf("%-10s %10ld %10ld %10ld %12.0f\n", X->name, X->checked, X->skipped, X->failed,
+               X->seconds>0 ? ran/X->seconds : 0);
+        failed += X->failed;
+    }
+    return(failed);
+}
+
+int main(int argc, char * argv[]) {
+
+    int rounds = 200, order = 100, queries = 50, bench = 0;
+    Check C;
+    C.procs = DIST_PROCS;
+
+    // Read the options
+    int a = 1;
+    for(; a<argc; a++) {
+        if(strcmp(argv[a], "-r")==0 && a+1<argc) {
+            rounds = atoi(argv[++a]);
+        } else if(strcmp(argv[a], "-n")==0 && a+1<argc) {
+            order = atoi(argv[++a]);
+        } else if(strcmp(argv[a], "-q")==0 && a+1<argc) {
+            queries = atoi(argv[++a]);
+        } else if(strcmp(argv[a], "-s")==0 && a+1<argc) {
+            seed = strtoull(argv[++a], NULL, 10);
+        } else if(strcmp(argv[a], "-b")==0 && a+1<argc) {
+            bench = atoi(argv[++a]);
+        } else if(strcmp(argv[a], "-P")==0 && a+1<argc) {
+            C.procs = atoi(argv[++a]);
+        } else {
+            break;
+        }
+    }
+    if(a!=argc || rounds<0 || order<1 || queries<1 || bench<0 || C.procs<0) {
+        printf("Usage: %s [-r rounds] [-n order] [-q queries] [-s seed] [-b order] [-P procs]\n", argv[0]);
+        exit(1);
+    }
+
+    // Name the files for the graphs on disk
+    char extPath[4096], distPath[4096];
+    char* dir = getenv("TMPDIR")!=NULL ? getenv("TMPDIR") : "/tmp";
+    snprintf(extPath, sizeof(extPath), "%s/bfscheck-%d.adj", dir, (int)getpid());
+    snprintf(distPath, sizeof(distPath), "%s/bfscheck-%d.txt", dir, (int)getpid());
+    C.extPath = extPath;
+    C.distPath = distPath;
+
+    // Check random graphs of every family and order up to the given one,
+    // a third of them directed, or time one large sparse graph
+    printf("Seed %llu\n", (unsigned long long)seed);
+    double reference = 0;
+    int searches = 0;
+    if(bench > 0) {
+        randomGraph(&C, bench, 1, 0);
+        buildCheck(&C);
+        checkQueries(&C, queries, &searches, &reference);
+        freeCheck(&C);
+    }
+    for(int r=0; r<rounds && bench==0; r++) {
+        randomGraph(&C, randomBelow(order) + 1, randomBelow(3), randomBelow(3)==0);
+        buildCheck(&C);
+        checkQueries(&C, queries, &searches, &reference);
+        freeCheck(&C);
+    }
+    unlink(extPath);
+    unlink(distPath);
+
+    long failed = printTally(searches, reference);
+    if(failed > 0) {
+        printf("%ld mismatches\n", failed);
+        return(1);
+    }
+    printf("All engines agree\n");
+    return(0);
+}
@@ -0,0 +1,266 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "Centrality.h"
+
+// Number of sources a thread takes from the shared list at a time
+#define SOURCE_CHUNK 16
+
+// structs --------------------------------------------------------------------
+
+// Private Job type
+// The work shared by the threads of one call to centrality()
+typedef struct Job {
+    Graph graph;
+    // The sources to search from, handed out SOURCE_CHUNK at a time
+    int* source;
+    int sources;
+    int next;
+    pthread_mutex_t lock;
+    // Which results are wanted
+    int closeness;
+    int betweenness;
+} Job;
+
+// Private Worker type
+// One thread's Search and scratch arrays, and its share of the results,
+// all indexed by vertex
+typedef struct Worker {
+    Job* job;
+    pthread_t thread;
+    // Number of shortest paths from the current source to each vertex,
+    // and the dependency of the source on each vertex
+    double* sigma;
+    double* delta;
+    // Distance of each vertex from the current source, or -1
+    int* depth;
+    // Sum of the distances to each vertex, and the number of sources that
+    // reach it, over the sources this thread has searched
+    double* farness;
+    int* reached;
+    // Betweenness summed over the sources this thread has searched
+    double* between;
+} Worker;
+
+// Private helpers ------------------------------------------------------------
+
+// Adds what one BFS from s tells about every vertex to the results of W.
+// The levels of the search give the vertices in order of distance, so the
+// number of shortest paths to each vertex can be counted going out level by
+// level, and Brandes' dependencies summed coming back in the reverse order.
+static void addSource(Worker* W, Search S, int s) {
+
+    Job* J = W->job;
+    int levels;
+    const int* adj;
+
+    // Call BFS on source s
+    searchBFS(S, s);
+    levels = searchLevels(S);
+
+    // Record the distance of every vertex reached, and clear its counts
+    for(int d=0; d<levels; d++) {
+        const int* L = searchLevel(S, d);
+        int size = searchLevelSize(S, d);
+        for(int i=0; i<size; i++) {
+            W->depth[L[i]] = d;
+            W->sigma[L[i]] = 0;
+            W->delta[L[i]] = 0;
+            if(J->closeness && d>0) {
+                W->farness[L[i]] += d;
+                W->reached[L[i]]++;
+            }
+        }
+    }
+
+    if(J->betweenness) {
+
+        // Count the shortest paths, each vertex passing its count on to
+        // the neighbors one level further out
+        W->sigma[s] = 1;
+        for(int d=0; d+1<levels; d++) {
+            const int* L = searchLevel(S, d);
+            int size = searchLevelSize(S, d);
+            for(int i=0; i<size; i++) {
+                int v = L[i];
+                int deg = searchNeighbors(S, v, &adj);
+                for(int j=0; j<deg; j++) {
+                    if(W->depth[adj[j]] == d+1) {
+                        W->sigma[adj[j]] += W->sigma[v];
+                    }
+                }
+            }
+        }
+
+        // Sum the dependencies from the farthest level back in
+        for(int d=levels-2; d>=0; d--) {
+            const int* L = searchLevel(S, d);
+            int size = searchLevelSize(S, d);
+            for(int i=0; i<size; i++) {
+                int v = L[i];
+                int deg = searchNeighbors(S, v, &adj);
+                double sum = 0;
+                for(int j=0; j<deg; j++) {
+                    int w = adj[j];
+                    if(W->depth[w] == d+1) {
+                        sum += (1 + W->delta[w]) / W->sigma[w];
+                    }
+                }
+                W->delta[v] = W->sigma[v] * sum;
+                if(v != s) {
+                    W->between[v] += W->delta[v];
+                }
+            }
+        }
+    }
+
+    // Mark every vertex reached as unreached again for the next source
+    for(int d=0; d<levels; d++) {
+        const int* L = searchLevel(S, d);
+        int size = searchLevelSize(S, d);
+        for(int i=0; i<size; i++) {
+            W->depth[L[i]] = -1;
+        }
+    }
+}
+
+// Body of each thread: takes sources from the Job until there are none left
+static void* workerMain(void* arg) {
+
+    Worker* W = arg;
+    Job* J = W->job;
+    int n = getOrder(J->graph);
+
+    // Create the Search and scratch arrays here, so that their pages
+    // are first touched, and so placed, by the thread using them
+    Search S = newSearch(J->graph);
+    W->sigma = newGraphArray(J->graph, MEMORY_SCRATCH, n+1, sizeof(double));
+    W->delta = newGraphArray(J->graph, MEMORY_SCRATCH, n+1, sizeof(double));
+    W->depth = newGraphArray(J->graph, MEMORY_SCRATCH, n+1, sizeof(int));
+    W->farness = newGraphArray(J->graph, MEMORY_SCRATCH, n+1, sizeof(double));
+    W->reached = newGraphArray(J->graph, MEMORY_SCRATCH, n+1, sizeof(int));
+    W->between = newGraphArray(J->graph, MEMORY_SCRATCH, n+1, sizeof(double));
+    for(int v=1; v<n+1; v++) {
+        W->depth[v] = -1;
+    }
+
+    while(1) {
+        pthread_mutex_lock(&J->lock);
+        int first = J->next;
+        J->next += SOURCE_CHUNK;
+        pthread_mutex_unlock(&J->lock);
+        if(first >= J->sources) {
+            break;
+        }
+        for(int i=first; i<first+SOURCE_CHUNK && i<J->sources; i++) {
+            addSource(W, S, J->source[i]);
+        }
+    }
+
+    freeSearch(&S);
+    freeGraphArray(J->graph, MEMORY_SCRATCH, W->sigma);
+    freeGraphArray(J->graph, MEMORY_SCRATCH, W->delta);
+    freeGraphArray(J->graph, MEMORY_SCRATCH, W->depth);
+    return NULL;
+}
+
+// Centrality -----------------------------------------------------------------
+
+// Computes the closeness and betweenness centrality of every vertex of G by
+// running BFS from each source on the given number of threads, each with its
+// own Search and scratch arrays. Path lengths count edges, not weights.
+// If samples is positive and less than the order of G, only that many sources,
+// picked at random in a way that is the same on every run, are searched, and
+// the results are estimates.
+// closeness[v] is set to the reciprocal of the average distance to v from the
+// sources (other than v) that reach it, or 0 if none do; for an undirected
+// graph this is the usual closeness of v within its component.
+// betweenness[v] is set to the number of shortest s-t paths through v, summed
+// over the ordered pairs of sources s and targets t other than v, by Brandes'
+// algorithm, where a pair joined by several shortest paths counts each one
+// in proportion. With samples the sum is scaled up to stand for every source.
+// An undirected graph counts each pair twice, once in each order.
+// Both arrays must have room for the order of G plus 1, and are indexed by
+// vertex. Either may be NULL if it isn't wanted.
+void centrality(Graph G, double* closeness, double* betweenness, int samples, int threads) {
+
+    // Check if the Graph is NULL
+    if(G == NULL) {
+        printf("Centrality Error: calling centrality() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    int n = getOrder(G);
+    Job J;
+    J.graph = G;
+    J.closeness = (closeness != NULL);
+    J.betweenness = (betweenness != NULL);
+    J.next = 0;
+    pthread_mutex_init(&J.lock, NULL);
+    if(threads < 1) {
+        threads = 1;
+    }
+
+    // List the sources, shuffling the front of the list into a sample
+    // with a fixed xorshift generator if not every source is wanted
+    J.source = newGraphArray(G, MEMORY_SCRATCH, n, sizeof(int));
+    for(int i=0; i<n; i++) {
+        J.source[i] = i+1;
+    }
+    J.sources = n;
+    if(samples>0 && samples<n) {
+        unsigned int x = 2463534242u;
+        for(int i=0; i<samples; i++) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            int j = i + (int)(x % (unsigned int)(n-i));
+            int t = J.source[i];
+            J.source[i] = J.source[j];
+            J.source[j] = t;
+        }
+        J.sources = samples;
+    }
+
+    // Search from every source on the threads
+    Worker* W = newGraphArray(G, MEMORY_SCRATCH, threads, sizeof(Worker));
+    for(int t=0; t<threads; t++) {
+        W[t].job = &J;
+        if(pthread_create(&W[t].thread, NULL, workerMain, &W[t]) != 0) {
+            printf("Centrality Error: unable to start thread %d\n", t);
+            exit(1);
+        }
+    }
+    for(int t=0; t<threads; t++) {
+        pthread_join(W[t].thread, NULL);
+    }
+
+    // Add up the shares of the threads
+    double scale = (double)n / J.sources;
+    for(int v=1; v<n+1; v++) {
+        double farness = 0;
+        long reached = 0;
+        double between = 0;
+        for(int t=0; t<threads; t++) {
+            farness += W[t].farness[v];
+            reached += W[t].reached[v];
+            between += W[t].between[v];
+        }
+        if(closeness != NULL) {
+            closeness[v] = farness>0 ? reached / farness : 0;
+        }
+        if(betweenness != NULL) {
+            betweenness[v] = between * scale;
+        }
+    }
+
+    // Free the shares and the sources
+    for(int t=0; t<threads; t++) {
+        freeGraphArray(G, MEMORY_SCRATCH, W[t].farness);
+        freeGraphArray(G, MEMORY_SCRATCH, W[t].reached);
+        freeGraphArray(G, MEMORY_SCRATCH, W[t].between);
+    }
+    freeGraphArray(G, MEMORY_SCRATCH, W);
+    freeGraphArray(G, MEMORY_SCRATCH, J.source);
+    pthread_mutex_destroy(&J.lock);
+}
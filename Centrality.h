@@ -0,0 +1,23 @@
+#ifndef _CENTRALITY_H_INCLUDE_
+#define _CENTRALITY_H_INCLUDE_
+#include "Graph.h"
+
+// Computes the closeness and betweenness centrality of every vertex of G by
+// running BFS from each source on the given number of threads, each with its
+// own Search and scratch arrays. Path lengths count edges, not weights.
+// If samples is positive and less than the order of G, only that many sources,
+// picked at random in a way that is the same on every run, are searched, and
+// the results are estimates.
+// closeness[v] is set to the reciprocal of the average distance to v from the
+// sources (other than v) that reach it, or 0 if none do; for an undirected
+// graph this is the usual closeness of v within its component.
+// betweenness[v] is set to the number of shortest s-t paths through v, summed
+// over the ordered pairs of sources s and targets t other than v, by Brandes'
+// algorithm, where a pair joined by several shortest paths counts each one
+// in proportion. With samples the sum is scaled up to stand for every source.
+// An undirected graph counts each pair twice, once in each order.
+// Both arrays must have room for the order of G plus 1, and are indexed by
+// vertex. Either may be NULL if it isn't wanted.
+void centrality(Graph G, double* closeness, double* betweenness, int samples, int threads);
+
+#endif
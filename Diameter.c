@@ -0,0 +1,568 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "Diameter.h"
+
+// structs --------------------------------------------------------------------
+
+// Private EccentricityObj type
+// Bounds on the eccentricity of every vertex, and on the diameter of every
+// connected component, with the buffers of the searches that tighten them.
+// Components are numbered from 1, and arrays by vertex are indexed from 1.
+typedef struct EccentricityObj {
+    Graph graph;
+    // Used only to read adjacency lists, so that each search only touches
+    // the component it runs in
+    Search search;
+    int order;
+    // Lower and upper bounds on the eccentricity of each vertex
+    int* lower;
+    int* upper;
+    // Component of each vertex
+    int* component;
+    int components;
+    // Number of vertices in each component, the vertex of greatest degree
+    // in it, and lower and upper bounds on its diameter
+    int* size;
+    int* hub;
+    int* low;
+    int* high;
+    // The component with the most vertices, and its vertices
+    int largest;
+    int* member;
+    // Vertices reached by the last search in order of distance, with where
+    // each level starts, and their parents; mark is -1 except during a search
+    int* queue;
+    int* start;
+    int* parent;
+    int* mark;
+    int levels;
+    int reached;
+    // Levels of the search from the center of a component, kept by diameter()
+    // while searches from its outer vertices overwrite the ones above
+    int* fringe;
+    int* fringeStart;
+    int searches;
+    EccentricityProgress progress;
+    void* context;
+} EccentricityObj;
+
+// Private Candidate type
+// A component diameter() may still have to search, with its upper bound
+typedef struct Candidate {
+    int component;
+    int bound;
+} Candidate;
+
+// Private helpers ------------------------------------------------------------
+
+// Runs a BFS from v over the component of v only, leaving the vertices it
+// reaches in E->queue level by level and their parents in E->parent. Unlike
+// searchBFS() it doesn't reset anything outside the component, so searching
+// every small component of a graph costs no more than the graph's size.
+static void explore(Eccentricity E, int v) {
+
+    int* Q = E->queue;
+    int head = 0, tail = 0;
+    const int* adj;
+
+    Q[tail++] = v;
+    E->mark[v] = 0;
+    E->parent[v] = NIL;
+    E->levels = 0;
+    while(head < tail) {
+        int end = tail;
+        E->start[E->levels++] = head;
+        for(; head<end; head++) {
+            int u = Q[head];
+            int deg = searchNeighbors(E->search, u, &adj);
+            for(int j=0; j<deg; j++) {
+                int w = adj[j];
+                if(E->mark[w] < 0) {
+                    E->mark[w] = E->levels;
+                    E->parent[w] = u;
+                    Q[tail++] = w;
+                }
+            }
+        }
+    }
+    E->start[E->levels] = tail;
+    E->reached = tail;
+
+    // Leave every vertex unmarked for the next search
+    for(int i=0; i<tail; i++) {
+        E->mark[Q[i]] = -1;
+    }
+    E->searches++;
+}
+
+// Tightens the bounds on every vertex reached by the last search, and on the
+// diameter of its component. A vertex w at distance d from a source s of
+// eccentricity e has an eccentricity of at least d and e-d, by the triangle
+// inequality, and of at most e+d, and the diameter is at most 2e.
+static void tighten(Eccentricity E) {
+
+    int e = E->levels - 1;
+    int c = E->component[E->queue[0]];
+
+    for(int d=0; d<E->levels; d++) {
+        int least = d>e-d ? d : e-d;
+        for(int i=E->start[d]; i<E->start[d+1]; i++) {
+            int w = E->queue[i];
+            if(E->lower[w] < least) {
+                E->lower[w] = least;
+            }
+            if(E->upper[w] > e+d) {
+                E->upper[w] = e+d;
+            }
+        }
+    }
+    if(E->low[c] < e) {
+        E->low[c] = e;
+    }
+    if(E->high[c] > 2*e) {
+        E->high[c] = 2*e;
+    }
+}
+
+// Runs a BFS from v, tightens the bounds with it, and returns the
+// eccentricity of v
+static int sweep(Eccentricity E, int v) {
+    explore(E, v);
+    tighten(E);
+    return(E->levels - 1);
+}
+
+// Returns the vertex halfway along a longest path of the last search
+static int middle(Eccentricity E) {
+
+    int v = E->queue[E->reached-1];
+
+    for(int i=0; i<(E->levels-1)/2; i++) {
+        v = E->parent[v];
+    }
+    return(v);
+}
+
+// Passes the bounds on to the progress function, if there is one
+static void report(Eccentricity E, int lower, int upper) {
+    if(E->progress != NULL) {
+        E->progress(E->context, lower, upper, E->searches);
+    }
+}
+
+// Orders Candidates by decreasing bound
+static int byBound(const void* a, const void* b) {
+    const Candidate* x = a;
+    const Candidate* y = b;
+    return((y->bound > x->bound) - (y->bound < x->bound));
+}
+
+// Constructors-Destructors ---------------------------------------------------
+
+// Returns bounds on the eccentricities of the vertices of the undirected
+// Graph G, which must not change while they are in use. Runs one BFS in each
+// connected component to find the components, so every bound is already
+// within a factor of 2 of the truth. The eccentricity of a vertex is its
+// greatest distance, in edges, to a vertex of its own component.
+Eccentricity newEccentricity(Graph G) {
+
+    // Check if this Graph is NULL
+    if(G == NULL) {
+        printf("Diameter Error: calling newEccentricity() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    // The bounds only hold when every distance is symmetric
+    if(isDirected(G)) {
+        printf("Diameter Error: calling newEccentricity() on directed Graph\n");
+        exit(1);
+    }
+
+    int n = getOrder(G);
+    const int* adj;
+    Eccentricity E = newGraphArray(G, MEMORY_VERTEX, 1, sizeof(EccentricityObj));
+    E->graph = G;
+    E->search = newSearch(G);
+    E->order = n;
+    E->lower = newGraphArray(G, MEMORY_VERTEX, n+1, sizeof(int));
+    E->upper = newGraphArray(G, MEMORY_VERTEX, n+1, sizeof(int));
+    E->component = newGraphArray(G, MEMORY_VERTEX, n+1, sizeof(int));
+    E->size = newGraphArray(G, MEMORY_VERTEX, n+1, sizeof(int));
+    E->hub = newGraphArray(G, MEMORY_VERTEX, n+1, sizeof(int));
+    E->low = newGraphArray(G, MEMORY_VERTEX, n+1, sizeof(int));
+    E->high = newGraphArray(G, MEMORY_VERTEX, n+1, sizeof(int));
+    E->queue = newGraphArray(G, MEMORY_VERTEX, n+1, sizeof(int));
+    E->start = newGraphArray(G, MEMORY_VERTEX, n+2, sizeof(int));
+    E->parent = newGraphArray(G, MEMORY_VERTEX, n+1, sizeof(int));
+    E->mark = newGraphArray(G, MEMORY_VERTEX, n+1, sizeof(int));
+    E->fringe = newGraphArray(G, MEMORY_VERTEX, n+1, sizeof(int));
+    E->fringeStart = newGraphArray(G, MEMORY_VERTEX, n+2, sizeof(int));
+    for(int v=1; v<n+1; v++) {
+        E->upper[v] = n;
+        E->mark[v] = -1;
+    }
+
+    // Search from each vertex not yet reached, which finds its component
+    for(int v=1; v<n+1; v++) {
+        if(E->component[v] != 0) {
+            continue;
+        }
+        int c = ++E->components;
+        explore(E, v);
+        E->size[c] = E->reached;
+        E->high[c] = E->reached - 1;
+        E->hub[c] = v;
+        int most = -1;
+        for(int i=0; i<E->reached; i++) {
+            int w = E->queue[i];
+            int deg = searchNeighbors(E->search, w, &adj);
+            E->component[w] = c;
+            if(deg > most) {
+                most = deg;
+                E->hub[c] = w;
+            }
+        }
+        tighten(E);
+        if(E->size[c] > E->size[E->largest]) {
+            E->largest = c;
+        }
+    }
+
+    // List the vertices of the largest component
+    E->member = newGraphArray(G, MEMORY_VERTEX, E->size[E->largest]+1, sizeof(int));
+    for(int v=1, i=0; v<n+1; v++) {
+        if(E->component[v] == E->largest) {
+            E->member[i++] = v;
+        }
+    }
+
+    return(E);
+}
+
+// Frees all heap memory associated with *pE, and sets *pE to NULL. Must
+// come before the Graph is freed, which counts the memory of the bounds.
+void freeEccentricity(Eccentricity* pE) {
+
+    if(pE!=NULL && *pE!=NULL) {
+        Eccentricity E = *pE;
+        freeSearch(&E->search);
+        freeGraphArray(E->graph, MEMORY_VERTEX, E->lower);
+        freeGraphArray(E->graph, MEMORY_VERTEX, E->upper);
+        freeGraphArray(E->graph, MEMORY_VERTEX, E->component);
+        freeGraphArray(E->graph, MEMORY_VERTEX, E->size);
+        freeGraphArray(E->graph, MEMORY_VERTEX, E->hub);
+        freeGraphArray(E->graph, MEMORY_VERTEX, E->low);
+        freeGraphArray(E->graph, MEMORY_VERTEX, E->high);
+        freeGraphArray(E->graph, MEMORY_VERTEX, E->member);
+        freeGraphArray(E->graph, MEMORY_VERTEX, E->queue);
+        freeGraphArray(E->graph, MEMORY_VERTEX, E->start);
+        freeGraphArray(E->graph, MEMORY_VERTEX, E->parent);
+        freeGraphArray(E->graph, MEMORY_VERTEX, E->mark);
+        freeGraphArray(E->graph, MEMORY_VERTEX, E->fringe);
+        freeGraphArray(E->graph, MEMORY_VERTEX, E->fringeStart);
+        freeGraphArray(E->graph, MEMORY_VERTEX, E);
+        *pE = NULL;
+    }
+}
+
+// Access functions -----------------------------------------------------------
+
+// Returns a lower bound on the eccentricity of vertex v
+int eccLower(Eccentricity E, int v) {
+
+    // Check if this Eccentricity is NULL
+    if(E == NULL) {
+        printf("Diameter Error: calling eccLower() on NULL Eccentricity reference\n");
+        exit(1);
+    }
+
+    // Checks if v is a valid vertex
+    if(v<1 || v>E->order) {
+        printf("Diameter Error: eccLower() called on improper vertex\n");
+        exit(1);
+    }
+
+    return(E->lower[v]);
+}
+
+// Returns an upper bound on the eccentricity of vertex v
+int eccUpper(Eccentricity E, int v) {
+
+    // Check if this Eccentricity is NULL
+    if(E == NULL) {
+        printf("Diameter Error: calling eccUpper() on NULL Eccentricity reference\n");
+        exit(1);
+    }
+
+    // Checks if v is a valid vertex
+    if(v<1 || v>E->order) {
+        printf("Diameter Error: eccUpper() called on improper vertex\n");
+        exit(1);
+    }
+
+    return(E->upper[v]);
+}
+
+// Returns lower and upper bounds on the diameter of the Graph, the greatest
+// eccentricity of any of its vertices
+int diameterLower(Eccentricity E) {
+
+    // Check if this Eccentricity is NULL
+    if(E == NULL) {
+        printf("Diameter Error: calling diameterLower() on NULL Eccentricity reference\n");
+        exit(1);
+    }
+
+    int lower = 0;
+    for(int c=1; c<E->components+1; c++) {
+        if(E->low[c] > lower) {
+            lower = E->low[c];
+        }
+    }
+    return(lower);
+}
+
+int diameterUpper(Eccentricity E) {
+
+    // Check if this Eccentricity is NULL
+    if(E == NULL) {
+        printf("Diameter Error: calling diameterUpper() on NULL Eccentricity reference\n");
+        exit(1);
+    }
+
+    int upper = 0;
+    for(int c=1; c<E->components+1; c++) {
+        if(E->high[c] > upper) {
+            upper = E->high[c];
+        }
+    }
+    return(upper);
+}
+
+// Returns lower and upper bounds on the radius of the Graph, the least
+// eccentricity of a vertex of its largest component
+int radiusLower(Eccentricity E) {
+
+    // Check if this Eccentricity is NULL
+    if(E == NULL) {
+        printf("Diameter Error: calling radiusLower() on NULL Eccentricity reference\n");
+        exit(1);
+    }
+
+    int size = E->size[E->largest];
+    int lower = size>0 ? E->lower[E->member[0]] : 0;
+    for(int i=1; i<size; i++) {
+        if(E->lower[E->member[i]] < lower) {
+            lower = E->lower[E->member[i]];
+        }
+    }
+    return(lower);
+}
+
+int radiusUpper(Eccentricity E) {
+
+    // Check if this Eccentricity is NULL
+    if(E == NULL) {
+        printf("Diameter Error: calling radiusUpper() on NULL Eccentricity reference\n");
+        exit(1);
+    }
+
+    int size = E->size[E->largest];
+    int upper = size>0 ? E->upper[E->member[0]] : 0;
+    for(int i=1; i<size; i++) {
+        if(E->upper[E->member[i]] < upper) {
+            upper = E->upper[E->member[i]];
+        }
+    }
+    return(upper);
+}
+
+// Returns the number of BFS runs made so far
+int eccSearches(Eccentricity E) {
+
+    // Check if this Eccentricity is NULL
+    if(E == NULL) {
+        printf("Diameter Error: calling eccSearches() on NULL Eccentricity reference\n");
+        exit(1);
+    }
+
+    return(E->searches);
+}
+
+// Manipulation procedures ----------------------------------------------------
+
+// Sets the function called with the progress of diameter() and radius(),
+// or turns the reports off if progress is NULL
+void setEccProgress(Eccentricity E, EccentricityProgress progress, void* context) {
+
+    // Check if this Eccentricity is NULL
+    if(E == NULL) {
+        printf("Diameter Error: calling setEccProgress() on NULL Eccentricity reference\n");
+        exit(1);
+    }
+
+    E->progress = progress;
+    E->context = context;
+}
+
+// Runs a BFS from v, which tightens the bounds on every vertex of its
+// component, and returns the eccentricity of v
+int eccSweep(Eccentricity E, int v) {
+
+    // Check if this Eccentricity is NULL
+    if(E == NULL) {
+        printf("Diameter Error: calling eccSweep() on NULL Eccentricity reference\n");
+        exit(1);
+    }
+
+    // Checks if v is a valid vertex
+    if(v<1 || v>E->order) {
+        printf("Diameter Error: eccSweep() called on improper vertex\n");
+        exit(1);
+    }
+
+    return(sweep(E, v));
+}
+
+// Runs a BFS from v and another from the vertex found farthest from it,
+// and returns the eccentricity of the second, a lower bound on the diameter
+// that is often exact. Takes two searches whatever the size of the Graph.
+int doubleSweep(Eccentricity E, int v) {
+
+    // Check if this Eccentricity is NULL
+    if(E == NULL) {
+        printf("Diameter Error: calling doubleSweep() on NULL Eccentricity reference\n");
+        exit(1);
+    }
+
+    // Checks if v is a valid vertex
+    if(v<1 || v>E->order) {
+        printf("Diameter Error: doubleSweep() called on improper vertex\n");
+        exit(1);
+    }
+
+    sweep(E, v);
+    return(sweep(E, E->queue[E->reached-1]));
+}
+
+// Returns the exact diameter of the Graph, found with the iFUB algorithm
+// in each component whose diameter could still be the greatest: a BFS from a
+// central vertex picked by a 4-sweep, then a BFS from the vertices farthest
+// from it, level by level, until no vertex closer in can have a greater
+// eccentricity than one already found. Vertices whose bounds already rule
+// them out are skipped.
+int diameter(Eccentricity E) {
+
+    // Check if this Eccentricity is NULL
+    if(E == NULL) {
+        printf("Diameter Error: calling diameter() on NULL Eccentricity reference\n");
+        exit(1);
+    }
+
+    int lb = diameterLower(E);
+    int count = 0;
+
+    // Take the components that could hold a longer path than any found
+    // yet, those that could hold the longest first
+    Candidate* todo = newGraphArray(E->graph, MEMORY_SCRATCH, E->components+1, sizeof(Candidate));
+    for(int c=1; c<E->components+1; c++) {
+        if(E->high[c] > lb) {
+            todo[count].component = c;
+            todo[count].bound = E->high[c];
+            count++;
+        }
+    }
+    qsort(todo, count, sizeof(Candidate), byBound);
+
+    for(int k=0; k<count; k++) {
+        int c = todo[k].component;
+        int next = k+1<count ? todo[k+1].bound : lb;
+        int* low = &E->low[c];
+        int* high = &E->high[c];
+
+        // Pick a central vertex u by a 4-sweep from the hub of the component:
+        // the middle of a longest path from a vertex farthest from the hub,
+        // then the same again from the middle of that path
+        int u = E->hub[c];
+        for(int s=0; s<4 && *high>lb; s++) {
+            sweep(E, u);
+            u = (s%2==0) ? E->queue[E->reached-1] : middle(E);
+            lb = *low>lb ? *low : lb;
+            report(E, lb, *high>next ? *high : next);
+        }
+        if(*high <= lb) {
+            continue;
+        }
+
+        // Keep the levels of the search from u
+        int e = sweep(E, u);
+        lb = *low>lb ? *low : lb;
+        report(E, lb, *high>next ? *high : next);
+        for(int i=0; i<E->reached; i++) {
+            E->fringe[i] = E->queue[i];
+        }
+        for(int d=0; d<E->levels+1; d++) {
+            E->fringeStart[d] = E->start[d];
+        }
+
+        // Search from the vertices of each level in turn, farthest first.
+        // Once the vertices at distance i or more have been searched, any
+        // longer path has to join two vertices closer to u than i, which
+        // are at most 2(i-1) apart.
+        for(int i=e; i>0 && *high>lb; i--) {
+            for(int j=E->fringeStart[i]; j<E->fringeStart[i+1]; j++) {
+                int v = E->fringe[j];
+                if(E->upper[v] > lb) {
+                    sweep(E, v);
+                    lb = *low>lb ? *low : lb;
+                    report(E, lb, *high>next ? *high : next);
+                }
+            }
+            int bound = 2*(i-1)>lb ? 2*(i-1) : lb;
+            if(*high > bound) {
+                *high = bound;
+            }
+        }
+    }
+
+    freeGraphArray(E->graph, MEMORY_SCRATCH, todo);
+    return(diameterLower(E));
+}
+
+// Returns the exact radius of the Graph, found by running BFS from the
+// vertex of the largest component with the least lower bound on its
+// eccentricity, until no vertex can beat the least eccentricity found
+int radius(Eccentricity E) {
+
+    // Check if this Eccentricity is NULL
+    if(E == NULL) {
+        printf("Diameter Error: calling radius() on NULL Eccentricity reference\n");
+        exit(1);
+    }
+
+    int size = E->size[E->largest];
+
+    while(1) {
+        int upper = radiusUpper(E);
+
+        // Find the vertex that might have the least eccentricity, taking
+        // the one whose bounds are furthest apart among equals
+        int best = NIL;
+        for(int i=0; i<size; i++) {
+            int v = E->member[i];
+            if(E->lower[v] >= upper) {
+                continue;
+            }
+            if(best==NIL || E->lower[v]<E->lower[best]
+               || (E->lower[v]==E->lower[best] && E->upper[v]>E->upper[best])) {
+                best = v;
+            }
+        }
+        if(best == NIL) {
+            return(upper);
+        }
+
+        sweep(E, best);
+        report(E, radiusLower(E), radiusUpper(E));
+    }
+}
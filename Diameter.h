@@ -0,0 +1,76 @@
+#ifndef _DIAMETER_H_INCLUDE_
+#define _DIAMETER_H_INCLUDE_
+#include "Graph.h"
+
+// Exported types -------------------------------------------------------------
+typedef struct EccentricityObj* Eccentricity;
+
+// Called after every BFS run by diameter() and radius(), with the bounds
+// known so far on the value being computed and the number of searches run
+// since the Eccentricity was created
+typedef void (*EccentricityProgress)(void* context, int lower, int upper, int searches);
+
+
+// Constructors-Destructors ---------------------------------------------------
+
+// Returns bounds on the eccentricities of the vertices of the undirected
+// Graph G, which must not change while they are in use. Runs one BFS in each
+// connected component to find the components, so every bound is already
+// within a factor of 2 of the truth. The eccentricity of a vertex is its
+// greatest distance, in edges, to a vertex of its own component.
+Eccentricity newEccentricity(Graph G);
+
+// Frees all heap memory associated with *pE, and sets *pE to NULL. Must
+// come before the Graph is freed, which counts the memory of the bounds.
+void freeEccentricity(Eccentricity* pE);
+
+// Access functions -----------------------------------------------------------
+
+// Returns a lower bound on the eccentricity of vertex v
+int eccLower(Eccentricity E, int v);
+
+// Returns an upper bound on the eccentricity of vertex v
+int eccUpper(Eccentricity E, int v);
+
+// Returns lower and upper bounds on the diameter of the Graph, the greatest
+// eccentricity of any of its vertices
+int diameterLower(Eccentricity E);
+int diameterUpper(Eccentricity E);
+
+// Returns lower and upper bounds on the radius of the Graph, the least
+// eccentricity of a vertex of its largest component
+int radiusLower(Eccentricity E);
+int radiusUpper(Eccentricity E);
+
+// Returns the number of BFS runs made so far
+int eccSearches(Eccentricity E);
+
+// Manipulation procedures ----------------------------------------------------
+
+// Sets the function called with the progress of diameter() and radius(),
+// or turns the reports off if progress is NULL
+void setEccProgress(Eccentricity E, EccentricityProgress progress, void* context);
+
+// Runs a BFS from v, which tightens the bounds on every vertex of its
+// component, and returns the eccentricity of v
+int eccSweep(Eccentricity E, int v);
+
+// Runs a BFS from v and another from the vertex found farthest from it,
+// and returns the eccentricity of the second, a lower bound on the diameter
+// that is often exact. Takes two searches whatever the size of the Graph.
+int doubleSweep(Eccentricity E, int v);
+
+// Returns the exact diameter of the Graph, found with the iFUB algorithm
+// in each component whose diameter could still be the greatest: a BFS from a
+// central vertex picked by a 4-sweep, then a BFS from the vertices farthest
+// from it, level by level, until no vertex closer in can have a greater
+// eccentricity than one already found. Vertices whose bounds already rule
+// them out are skipped.
+int diameter(Eccentricity E);
+
+// Returns the exact radius of the Graph, found by running BFS from the
+// vertex of the largest component with the least lower bound on its
+// eccentricity, until no vertex can beat the least eccentricity found
+int radius(Eccentricity E);
+
+#endif
@@ -0,0 +1,848 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include "DistBFS.h"
+
+// Commands the calling process gives the workers
+#define COMMAND_BFS 1
+#define COMMAND_PRINT 2
+#define COMMAND_QUIT 3
+
+// structs --------------------------------------------------------------------
+
+// Private Control type
+// Lives in shared memory and carries each command to the workers
+typedef struct Control {
+    // Posted once for each worker by the calling process to start a command
+    sem_t start;
+    // Waited on by the workers at the end of every command
+    pthread_barrier_t all;
+    // Waited on by the workers alone between the steps of a command
+    pthread_barrier_t step;
+    int command;
+    // Source of a BFS
+    int argument;
+    // Number of levels reached by the most recent BFS
+    int levels;
+} Control;
+
+typedef struct DistGraphObj {
+
+    // The number of vertices of the graph
+    int order;
+    // The number of worker processes, and the number of vertices in the
+    // block of each; worker w owns vertices w*block+1 through (w+1)*block
+    int procs;
+    int block;
+    // Allocation policy (see Memory.h) of the arrays
+    int policy;
+    // Process ids of the workers
+    pid_t* pid;
+    // The calling process's end of a socket to each worker, which the
+    // worker writes a byte to once it has carried out a command (0, or 1
+    // if it couldn't), and which ends if it exits, and the ends still
+    // waited on for the current command. A file to print to is passed to
+    // the workers over it too.
+    int* done;
+    struct pollfd* watch;
+    // Vertex that was most recently used as source for distBFS()
+    int source;
+
+    // Everything below is shared with the workers
+    Control* control;
+    // Array of ints whose ith element is the parent of vertex i
+    int* parent;
+    // Array of ints whose ith element is the distance from the source to
+    // vertex i, or INF while vertex i is undiscovered
+    int* distance;
+    // Array of ints whose ith element is the position of vertex i in the
+    // order BFS() would have discovered its level in
+    int* rank;
+    // Number of vertices each worker has found on the newest level
+    int* active;
+    // Sort keys of the vertices each worker has found on the newest level,
+    // worker w's in key[w*block] onwards, in increasing order
+    long long* key;
+    // The inbox of worker w holds tail[w] messages, each a vertex it owns
+    // and a neighbor of it on the level being expanded, from
+    // inbox[2*inboxStart[w]] onwards. It has room for every edge ending at
+    // a vertex of w, which is the most it can receive on any level.
+    int* inbox;
+    long* inboxStart;
+    long* tail;
+
+} DistGraphObj;
+
+// Private Worker type
+// State private to one worker process: the adjacency lists of its block,
+// its part of the frontier, and a growing outbox for every worker
+typedef struct Worker {
+    int id;
+    int lo;
+    int hi;
+    // The neighbors of vertex v are target[offset[v-lo]..offset[v-lo+1]-1]
+    long* offset;
+    int* target;
+    // The worker's vertices on the level being expanded, and on the next
+    int* frontier;
+    int* next;
+    int size;
+    // Messages waiting to be delivered to each worker
+    int** out;
+    long* outCount;
+    long* outRoom;
+} Worker;
+
+// Private helpers ------------------------------------------------------------
+
+// Returns a new array of n elements of the given size, allocated with the
+// given policy. Exits with an error if there isn't enough memory for it.
+static void* distArray(long n, size_t size, int policy) {
+
+    void* A = newArray(n * size, policy);
+
+    // Make sure there was memory allocated for the array
+    if(A == NULL) {
+        printf("DistBFS Error: unable to allocate %ld bytes\n", (long)(n * size));
+        exit(1);
+    }
+
+    return(A);
+}
+
+// Returns the worker that owns vertex v
+static inline int owner(DistGraph D, int v) {
+    return((v-1) / D->block);
+}
+
+// Orders ints, or long longs, for qsort()
+static int compareInts(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return((x > y) - (x < y));
+}
+static int compareKeys(const void* a, const void* b) {
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+    return((x > y) - (x < y));
+}
+
+// Returns the number of the count keys in K that are less than x
+static int keysBelow(const long long* K, int count, long long x) {
+    int lo = 0;
+    int hi = count;
+    while(lo < hi) {
+        int mid = (lo + hi) / 2;
+        if(K[mid] < x) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Opens the graph file at path and reads its order. Exits with an error
+// if the file can't be opened or the order is missing.
+static FILE* openGraph(char* path, int* n) {
+
+    FILE* in = fopen(path, "r");
+    if(in == NULL) {
+        printf("Unable to open file %s for reading\n", path);
+        exit(1);
+    }
+    if(fscanf(in, "%d", n)!=1 || *n<1) {
+        printf("Error in first line of input %s\n", path);
+        exit(1);
+    }
+    return in;
+}
+
+// Reads the next edge of the graph file into u and v, returning false (0)
+// at the terminating "0 0". Exits with an error if the edge is improper.
+static int readEdge(FILE* in, char* path, int n, int* line, int* u, int* v) {
+
+    (*line)++;
+    if(fscanf(in, "%d %d", u, v) != 2) {
+        printf("Error in line %d of input %s\n", *line, path);
+        exit(1);
+    }
+    if(*u==0 || *v==0) {
+        return 0;
+    }
+    if(*u<1 || *u>n || *v<1 || *v>n) {
+        printf("Error in line %d of input %s\n", *line, path);
+        exit(1);
+    }
+    return 1;
+}
+
+// Queues the message (y, x) for worker q
+static void sendMessage(Worker* W, int q, int y, int x) {
+
+    if(W->outCount[q]+2 > W->outRoom[q]) {
+        W->outRoom[q] = 2*W->outRoom[q] + 64;
+        W->out[q] = realloc(W->out[q], W->outRoom[q] * sizeof(int));
+        if(W->out[q] == NULL) {
+            printf("DistBFS Error: unable to allocate an outbox\n");
+            _exit(1);
+        }
+    }
+    W->out[q][W->outCount[q]++] = y;
+    W->out[q][W->outCount[q]++] = x;
+}
+
+// Reads the adjacency lists of the block of W from the graph file at path,
+// keeping each one sorted like the adjacency Lists of a Graph
+static void loadBlock(DistGraph D, Worker* W, char* path) {
+
+    int n, u, v;
+    int line = 1;
+    int count = W->hi - W->lo + 1;
+    FILE* in = openGraph(path, &n);
+    long start = ftell(in);
+
+    // Count the neighbors of each vertex of the block
+    W->offset = distArray(count+1, sizeof(long), D->policy);
+    for(int i=0; i<count+1; i++) {
+        W->offset[i] = 0;
+    }
+    while(readEdge(in, path, n, &line, &u, &v)) {
+        if(W->lo<=u && u<=W->hi) {
+            W->offset[u-W->lo+1]++;
+        }
+        if(W->lo<=v && v<=W->hi) {
+            W->offset[v-W->lo+1]++;
+        }
+    }
+    for(int i=0; i<count; i++) {
+        W->offset[i+1] += W->offset[i];
+    }
+
+    // Read the edges again to fill the lists in, then sort each one
+    long* fill = distArray(count+1, sizeof(long), D->policy);
+    memcpy(fill, W->offset, (count+1) * sizeof(long));
+    W->target = distArray(W->offset[count]+1, sizeof(int), D->policy);
+    fseek(in, start, SEEK_SET);
+    line = 1;
+    while(readEdge(in, path, n, &line, &u, &v)) {
+        if(W->lo<=u && u<=W->hi) {
+            W->target[fill[u-W->lo]++] = v;
+        }
+        if(W->lo<=v && v<=W->hi) {
+            W->target[fill[v-W->lo]++] = u;
+        }
+    }
+    for(int i=0; i<count; i++) {
+        qsort(W->target + W->offset[i], W->offset[i+1]-W->offset[i], sizeof(int), compareInts);
+    }
+    freeArray(fill);
+    fclose(in);
+}
+
+// Runs the part of a BFS from s that falls to the worker W
+static void workerBFS(DistGraph D, Worker* W, int s) {
+
+    Control* C = D->control;
+    int n = D->order;
+    int me = W->id;
+    int d = 0;
+
+    // Mark the vertices of the block undiscovered, apart from the source
+    for(int v=W->lo; v<=W->hi; v++) {
+        D->parent[v] = NIL;
+        D->distance[v] = INF;
+    }
+    W->size = 0;
+    if(owner(D, s) == me) {
+        D->distance[s] = 0;
+        D->rank[s] = 0;
+        W->frontier[W->size++] = s;
+    }
+    pthread_barrier_wait(&C->step);
+
+    while(1) {
+
+        // Send every undiscovered neighbor of the frontier to its owner
+        for(int i=0; i<W->size; i++) {
+            int x = W->frontier[i];
+            for(long j=W->offset[x-W->lo]; j<W->offset[x-W->lo+1]; j++) {
+                int y = W->target[j];
+                if(D->distance[y] == INF) {
+                    sendMessage(W, owner(D, y), y, x);
+                }
+            }
+        }
+
+        // Deliver the outboxes, taking room in each inbox in one step
+        for(int q=0; q<D->procs; q++) {
+            if(W->outCount[q] > 0) {
+                long at = __sync_fetch_and_add(&D->tail[q], W->outCount[q]/2);
+                memcpy(D->inbox + 2*(D->inboxStart[q]+at), W->out[q], W->outCount[q] * sizeof(int));
+                W->outCount[q] = 0;
+            }
+        }
+        pthread_barrier_wait(&C->step);
+
+        // Settle the vertices found, each keeping the neighbor that BFS()
+        // would have expanded first as its parent
+        int found = 0;
+        int* M = D->inbox + 2*D->inboxStart[me];
+        for(long i=0; i<D->tail[me]; i++) {
+            int y = M[2*i];
+            int x = M[2*i+1];
+            if(D->distance[y] == INF) {
+                D->distance[y] = d + 1;
+                D->parent[y] = x;
+                W->next[found++] = y;
+            } else if(D->rank[x] < D->rank[D->parent[y]]) {
+                D->parent[y] = x;
+            }
+        }
+        D->tail[me] = 0;
+
+        // BFS() discovers a level in the order of the parents, and the
+        // children of one parent in the order of their labels
+        long long* K = D->key + (long)me*D->block;
+        for(int i=0; i<found; i++) {
+            int y = W->next[i];
+            K[i] = (long long)D->rank[D->parent[y]]*(n+1) + y;
+        }
+        qsort(K, found, sizeof(long long), compareKeys);
+        D->active[me] = found;
+        pthread_barrier_wait(&C->step);
+
+        // Rank the new level across every worker, and stop once it is empty
+        int total = 0;
+        for(int q=0; q<D->procs; q++) {
+            total += D->active[q];
+        }
+        d++;
+        if(total == 0) {
+            break;
+        }
+        for(int i=0; i<found; i++) {
+            int y = (int)(K[i] % (n+1));
+            int r = i;
+            for(int q=0; q<D->procs; q++) {
+                if(q != me) {
+                    r += keysBelow(D->key + (long)q*D->block, D->active[q], K[i]);
+                }
+            }
+            D->rank[y] = r;
+            W->frontier[i] = y;
+        }
+        W->size = found;
+    }
+
+    if(me == 0) {
+        C->levels = d;
+    }
+}
+
+// Sends a copy of the file descriptor fd over the socket sock, for
+// receiveDescriptor() in the process at the other end. Returns true (1) if
+// it was sent, or false (0) if that process has exited.
+static int sendDescriptor(int sock, int fd) {
+
+    char byte = 0;
+    struct iovec data = { &byte, 1 };
+    union {
+        struct cmsghdr header;
+        char space[CMSG_SPACE(sizeof(int))];
+    } control;
+    memset(&control, 0, sizeof(control));
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control.space;
+    message.msg_controllen = sizeof(control.space);
+    struct cmsghdr* C = CMSG_FIRSTHDR(&message);
+    C->cmsg_level = SOL_SOCKET;
+    C->cmsg_type = SCM_RIGHTS;
+    C->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(C), &fd, sizeof(int));
+
+    ssize_t sent;
+    while((sent = sendmsg(sock, &message, MSG_NOSIGNAL))<0 && errno==EINTR) {
+    }
+    return(sent == 1);
+}
+
+// Returns the file descriptor sent over the socket sock by sendDescriptor(),
+// now open in this process, or -1 if none arrived
+static int receiveDescriptor(int sock) {
+
+    char byte;
+    struct iovec data = { &byte, 1 };
+    union {
+        struct cmsghdr header;
+        char space[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control.space;
+    message.msg_controllen = sizeof(control.space);
+
+    ssize_t got;
+    while((got = recvmsg(sock, &message, 0))<0 && errno==EINTR) {
+    }
+    struct cmsghdr* C = got==1 ? CMSG_FIRSTHDR(&message) : NULL;
+    if(C==NULL || C->cmsg_level!=SOL_SOCKET || C->cmsg_type!=SCM_RIGHTS
+       || C->cmsg_len!=CMSG_LEN(sizeof(int))) {
+        return(-1);
+    }
+    int fd;
+    memcpy(&fd, CMSG_DATA(C), sizeof(int));
+    return(fd);
+}
+
+// Prints the adjacency lists of the block of W to the file descriptor fd,
+// which it closes. Returns true (1) if they were all written, otherwise
+// false (0).
+static int workerPrint(Worker* W, int fd) {
+
+    FILE* out = fd>=0 ? fdopen(fd, "w") : NULL;
+    if(out == NULL) {
+        if(fd >= 0) {
+            close(fd);
+        }
+        return 0;
+    }
+    for(int v=W->lo; v<=W->hi; v++) {
+        fprintf(out, "%d: ", v);
+        for(long j=W->offset[v-W->lo]; j<W->offset[v-W->lo+1]; j++) {
+            fprintf(out, j>W->offset[v-W->lo] ? " %d" : "%d", W->target[j]);
+        }
+        fprintf(out, "\n");
+    }
+    int ok = !ferror(out);
+    return((fclose(out) == 0) && ok);
+}
+
+// Body of worker process w: loads its block, then carries out commands
+// until told to quit, writing a byte to the socket fd as it finishes each
+// one: 0 if it carried the command out, or 1 if it couldn't
+static void workerMain(DistGraph D, int w, char* path, int fd) {
+
+    Control* C = D->control;
+    Worker W;
+    W.id = w;
+    W.lo = w*D->block + 1;
+    W.hi = (w+1)*D->block < D->order ? (w+1)*D->block : D->order;
+    if(W.hi < W.lo) {
+        W.hi = W.lo - 1;
+    }
+
+    loadBlock(D, &W, path);
+    W.frontier = distArray(D->block, sizeof(int), D->policy);
+    W.next = distArray(D->block, sizeof(int), D->policy);
+    W.out = calloc(D->procs, sizeof(int*));
+    W.outCount = calloc(D->procs, sizeof(long));
+    W.outRoom = calloc(D->procs, sizeof(long));
+
+    while(1) {
+        while(sem_wait(&C->start)!=0 && errno==EINTR) {
+        }
+        int command = C->command;
+        char failed = 0;
+        if(command == COMMAND_BFS) {
+            workerBFS(D, &W, C->argument);
+        } else if(command == COMMAND_PRINT) {
+            // Print the blocks one after another, in order, to the file
+            // the calling process sent
+            int out = receiveDescriptor(fd);
+            for(int q=0; q<D->procs; q++) {
+                if(q == w) {
+                    failed = !workerPrint(&W, out);
+                }
+                pthread_barrier_wait(&C->step);
+            }
+        }
+        pthread_barrier_wait(&C->all);
+        if(write(fd, &failed, 1) != 1) {
+            _exit(1);
+        }
+        if(command == COMMAND_QUIT) {
+            break;
+        }
+    }
+
+    fflush(stdout);
+    _exit(0);
+}
+
+// Hands a command to the workers of D and waits for them to carry it out.
+// The argument of COMMAND_PRINT is the file descriptor to print to, which
+// is sent to every worker, as its number means nothing in their processes
+// if the file was opened after they started. Exits with an error if a
+// worker exits first, since the others would wait for it forever, or if
+// one couldn't carry the command out.
+static void runCommand(DistGraph D, int command, int argument) {
+
+    D->control->command = command;
+    D->control->argument = argument;
+    for(int w=0; w<D->procs; w++) {
+        if(command==COMMAND_PRINT && !sendDescriptor(D->done[w], argument)) {
+            printf("DistBFS Error: worker %d exited before finishing its work\n", w);
+            exit(1);
+        }
+    }
+    for(int w=0; w<D->procs; w++) {
+        D->watch[w].fd = D->done[w];
+        D->watch[w].events = POLLIN;
+        sem_post(&D->control->start);
+    }
+
+    // Wait for a byte from every worker, or for the end of its socket
+    int left = D->procs;
+    while(left > 0) {
+        if(poll(D->watch, D->procs, -1) < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            printf("DistBFS Error: unable to wait for the workers\n");
+            exit(1);
+        }
+        for(int w=0; w<D->procs; w++) {
+            char c;
+            if(D->watch[w].fd<0 || D->watch[w].revents==0) {
+                continue;
+            }
+            if(read(D->watch[w].fd, &c, 1) != 1) {
+                printf("DistBFS Error: worker %d exited before finishing its work\n", w);
+                exit(1);
+            }
+            if(c != 0) {
+                printf("DistBFS Error: worker %d was unable to print its part of the graph\n", w);
+                exit(1);
+            }
+            D->watch[w].fd = -1;
+            left--;
+        }
+    }
+}
+
+// Constructors-Destructors ---------------------------------------------------
+
+// Returns a new DistGraph for the graph in the file at path, which is in
+// the input format of FindPath (the order, then one edge per line up to
+// "0 0"), split over procs worker processes. Shared and private arrays are
+// allocated with the given policy (see Memory.h). Exits with an error if
+// the file can't be read, or once a worker has exited because its part
+// couldn't be.
+DistGraph newDistGraph(char* path, int procs, int policy) {
+
+    int n, u, v;
+    int line = 1;
+
+    // Check that there is at least one worker
+    if(procs < 1) {
+        printf("DistBFS Error: calling newDistGraph() with %d workers\n", procs);
+        exit(1);
+    }
+
+    // Allocate memory for the graph
+    DistGraph D = malloc(sizeof(DistGraphObj));
+
+    // Make sure there was memory allocated for the graph
+    if(D == NULL) {
+        printf("DistBFS Error: unable to allocate a DistGraph\n");
+        exit(1);
+    }
+
+    // Read the order, and cut the vertices into blocks
+    FILE* in = openGraph(path, &n);
+    D->order = n;
+    D->procs = procs;
+    D->block = (n + procs - 1) / procs;
+    D->policy = policy & ~ALLOC_SHARED;
+    D->source = NIL;
+
+    // Count the edges ending in each block, which sizes its inbox
+    int shared = policy | ALLOC_SHARED;
+    D->inboxStart = distArray(procs+1, sizeof(long), shared);
+    for(int q=0; q<procs+1; q++) {
+        D->inboxStart[q] = 0;
+    }
+    while(readEdge(in, path, n, &line, &u, &v)) {
+        D->inboxStart[owner(D, u)+1]++;
+        D->inboxStart[owner(D, v)+1]++;
+    }
+    fclose(in);
+    for(int q=0; q<procs; q++) {
+        D->inboxStart[q+1] += D->inboxStart[q];
+    }
+
+    // Allocate the arrays shared with the workers
+    D->control = distArray(1, sizeof(Control), shared);
+    D->parent = distArray(n+1, sizeof(int), shared);
+    D->distance = distArray(n+1, sizeof(int), shared);
+    D->rank = distArray(n+1, sizeof(int), shared);
+    D->active = distArray(procs, sizeof(int), shared);
+    D->key = distArray((long)procs*D->block, sizeof(long long), shared);
+    D->inbox = distArray(2*D->inboxStart[procs]+2, sizeof(int), shared);
+    D->tail = distArray(procs, sizeof(long), shared);
+    for(int i=1; i<n+1; i++) {
+        D->parent[i] = NIL;
+        D->distance[i] = INF;
+    }
+    for(int q=0; q<procs; q++) {
+        D->tail[q] = 0;
+    }
+    D->control->levels = 0;
+
+    // The barriers must work across processes
+    pthread_barrierattr_t attr;
+    pthread_barrierattr_init(&attr);
+    pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_barrier_init(&D->control->all, &attr, procs);
+    pthread_barrier_init(&D->control->step, &attr, procs);
+    pthread_barrierattr_destroy(&attr);
+    sem_init(&D->control->start, 1, 0);
+
+    // Open a socket to each worker
+    D->pid = distArray(procs, sizeof(pid_t), ALLOC_DEFAULT);
+    D->done = distArray(procs, sizeof(int), ALLOC_DEFAULT);
+    D->watch = distArray(procs, sizeof(struct pollfd), ALLOC_DEFAULT);
+    int* feed = distArray(procs, sizeof(int), ALLOC_DEFAULT);
+    for(int w=0; w<procs; w++) {
+        int fd[2];
+        if(socketpair(AF_UNIX, SOCK_STREAM, 0, fd) != 0) {
+            printf("DistBFS Error: unable to open a socket for worker %d\n", w);
+            exit(1);
+        }
+        D->done[w] = fd[0];
+        feed[w] = fd[1];
+    }
+
+    // Start the workers, with nothing left in any output buffer for them
+    // to write out a second time. Each keeps only its own end of its own
+    // socket, so the socket ends as soon as it exits.
+    fflush(NULL);
+    for(int w=0; w<procs; w++) {
+        D->pid[w] = fork();
+        if(D->pid[w] < 0) {
+            printf("DistBFS Error: unable to start worker %d\n", w);
+            exit(1);
+        }
+        if(D->pid[w] == 0) {
+            // Don't outlive the calling process
+            prctl(PR_SET_PDEATHSIG, SIGKILL);
+            for(int q=0; q<procs; q++) {
+                close(D->done[q]);
+                if(q!=w && feed[q]>=0) {
+                    close(feed[q]);
+                }
+            }
+            workerMain(D, w, path, feed[w]);
+        }
+        close(feed[w]);
+        feed[w] = -1;
+    }
+    freeArray(feed);
+
+    return(D);
+}
+
+// Stops the workers of *pD and frees all memory associated with it,
+// then sets the handle *pD to NULL
+void freeDistGraph(DistGraph* pD) {
+
+    // Checks if pD or its pointer is NULL
+    if(pD!=NULL && *pD!=NULL) {
+        DistGraph D = *pD;
+
+        // Tell the workers to quit and wait for them
+        runCommand(D, COMMAND_QUIT, 0);
+        for(int w=0; w<D->procs; w++) {
+            waitpid(D->pid[w], NULL, 0);
+        }
+
+        for(int w=0; w<D->procs; w++) {
+            close(D->done[w]);
+        }
+        sem_destroy(&D->control->start);
+        pthread_barrier_destroy(&D->control->all);
+        pthread_barrier_destroy(&D->control->step);
+        freeArray(D->control);
+        freeArray(D->parent);
+        freeArray(D->distance);
+        freeArray(D->rank);
+        freeArray(D->active);
+        freeArray(D->key);
+        freeArray(D->inbox);
+        freeArray(D->inboxStart);
+        freeArray(D->tail);
+        freeArray(D->pid);
+        freeArray(D->done);
+        freeArray(D->watch);
+        free(D);
+        *pD = NULL;
+    }
+
+}
+
+// Access functions -----------------------------------------------------------
+
+// Returns the number of vertices of D
+int distOrder(DistGraph D) {
+
+    // Check if this DistGraph is NULL
+    if(D == NULL) {
+        printf("DistBFS Error: calling distOrder() on NULL DistGraph reference\n");
+        exit(1);
+    }
+
+    return(D->order);
+}
+
+// Returns the source of the most recent distBFS(), or NIL if it has not run
+int distSource(DistGraph D) {
+
+    // Check if this DistGraph is NULL
+    if(D == NULL) {
+        printf("DistBFS Error: calling distSource() on NULL DistGraph reference\n");
+        exit(1);
+    }
+
+    return(D->source);
+}
+
+// Returns the parent of vertex u in the Breadth-First tree created by
+// distBFS(), or NIL if it has not run
+int distParent(DistGraph D, int u) {
+
+    // Check if this DistGraph is NULL
+    if(D == NULL) {
+        printf("DistBFS Error: calling distParent() on NULL DistGraph reference\n");
+        exit(1);
+    }
+
+    // Check if u is a valid vertex
+    if(u<1 || u>D->order) {
+        printf("DistBFS Error: distParent() called on improper vertex");
+        exit(1);
+    }
+
+    return(D->parent[u]);
+}
+
+// Returns the distance from the most recent distBFS() source to vertex u,
+// or INF if it has not run
+int distDist(DistGraph D, int u) {
+
+    // Check if this DistGraph is NULL
+    if(D == NULL) {
+        printf("DistBFS Error: calling distDist() on NULL DistGraph reference\n");
+        exit(1);
+    }
+
+    // Check if u is a valid vertex
+    if(u<1 || u>D->order) {
+        printf("DistBFS Error: distDist() called on improper vertex");
+        exit(1);
+    }
+
+    return(D->distance[u]);
+}
+
+// Appends to the List L the vertices of a shortest path from the source of
+// the most recent distBFS() to u, or appends NIL if no such path exists
+void distPath(List L, DistGraph D, int u) {
+
+    // Check if this DistGraph is NULL
+    if(D == NULL) {
+        printf("DistBFS Error: calling distPath() on NULL DistGraph reference\n");
+        exit(1);
+    }
+
+    // Check that distBFS() was called and u is a valid vertex
+    if(D->source==NIL || u<1 || u>D->order) {
+        printf("DistBFS Error: distPath() called on improper DistGraph");
+        exit(1);
+    }
+
+    // There is no path if u wasn't reached
+    if(D->distance[u] == INF) {
+        append(L, NIL);
+        return;
+    }
+
+    // Walk back from u to the source, then append the vertices in reverse
+    int length = D->distance[u];
+    int* path = malloc((length+1) * sizeof(int));
+    for(int i=length, x=u; i>=0; i--, x=D->parent[x]) {
+        path[i] = x;
+    }
+    appendArray(L, path, length+1);
+    free(path);
+}
+
+// Returns the number of levels reached by the most recent distBFS()
+int distLevels(DistGraph D) {
+
+    // Check if this DistGraph is NULL
+    if(D == NULL) {
+        printf("DistBFS Error: calling distLevels() on NULL DistGraph reference\n");
+        exit(1);
+    }
+
+    return(D->control->levels);
+}
+
+// Manipulation procedures ----------------------------------------------------
+
+// Runs BFS from s over the workers of D. Each level is ranked in the order
+// BFS() would have discovered it, so every vertex takes the same parent as
+// it would from BFS(): the neighbor one level closer to s that comes first
+// in that order. The result doesn't depend on how the workers are timed.
+void distBFS(DistGraph D, int s) {
+
+    // Check if this DistGraph is NULL
+    if(D == NULL) {
+        printf("DistBFS Error: calling distBFS() on NULL DistGraph reference\n");
+        exit(1);
+    }
+
+    // Checks if s is a valid vertex
+    if(s<1 || s>D->order) {
+        printf("DistBFS Error: distBFS() called on improper source");
+        exit(1);
+    }
+
+    runCommand(D, COMMAND_BFS, s);
+    D->source = s;
+}
+
+// Other operations -----------------------------------------------------------
+
+// Prints the adjacency list representation of D to out, in the same form as
+// printGraph(), with each worker writing the lines of its own vertices to
+// a copy of the file descriptor of out, which may have been opened after D
+// was made. Exits with an error if a worker is unable to write.
+void printDistGraph(FILE* out, DistGraph D) {
+
+    // Check if this DistGraph is NULL
+    if(D == NULL) {
+        printf("DistBFS Error: calling printDistGraph() on NULL DistGraph reference\n");
+        exit(1);
+    }
+
+    // The workers write straight to the file, after what is buffered here
+    fflush(out);
+    runCommand(D, COMMAND_PRINT, fileno(out));
+}
@@ -0,0 +1,72 @@
+#ifndef _DISTBFS_H_INCLUDE_
+#define _DISTBFS_H_INCLUDE_
+#include <stdio.h>
+#include <stdlib.h>
+#include "Graph.h"
+
+// Exported type --------------------------------------------------------------
+
+// A graph split over several local worker processes. The vertices are cut
+// into one block of consecutive labels per process, and each process reads
+// the graph file itself and keeps only the adjacency lists of its own block,
+// so no process ever holds the whole graph. BFS runs level by level: each
+// process expands its part of the frontier and sends every neighbor it finds
+// to the process that owns it, through inboxes in shared memory, and the
+// owners then settle their new vertices. The parent and distance of every
+// vertex are kept in shared memory, where the calling process reads them.
+typedef struct DistGraphObj* DistGraph;
+
+// Constructors-Destructors ---------------------------------------------------
+
+// Returns a new DistGraph for the graph in the file at path, which is in
+// the input format of FindPath (the order, then one edge per line up to
+// "0 0"), split over procs worker processes. Shared and private arrays are
+// allocated with the given policy (see Memory.h). Exits with an error if
+// the file can't be read, or once a worker has exited because its part
+// couldn't be.
+DistGraph newDistGraph(char* path, int procs, int policy);
+
+// Stops the workers of *pD and frees all memory associated with it,
+// then sets the handle *pD to NULL
+void freeDistGraph(DistGraph* pD);
+
+// Access functions -----------------------------------------------------------
+
+// Returns the number of vertices of D
+int distOrder(DistGraph D);
+
+// Returns the source of the most recent distBFS(), or NIL if it has not run
+int distSource(DistGraph D);
+
+// Returns the parent of vertex u in the Breadth-First tree created by
+// distBFS(), or NIL if it has not run
+int distParent(DistGraph D, int u);
+
+// Returns the distance from the most recent distBFS() source to vertex u,
+// or INF if it has not run
+int distDist(DistGraph D, int u);
+
+// Appends to the List L the vertices of a shortest path from the source of
+// the most recent distBFS() to u, or appends NIL if no such path exists
+void distPath(List L, DistGraph D, int u);
+
+// Returns the number of levels reached by the most recent distBFS()
+int distLevels(DistGraph D);
+
+// Manipulation procedures ----------------------------------------------------
+
+// Runs BFS from s over the workers of D. Each level is ranked in the order
+// BFS() would have discovered it, so every vertex takes the same parent as
+// it would from BFS(): the neighbor one level closer to s that comes first
+// in that order. The result doesn't depend on how the workers are timed.
+void distBFS(DistGraph D, int s);
+
+// Other operations -----------------------------------------------------------
+
+// Prints the adjacency list representation of D to out, in the same form as
+// printGraph(), with each worker writing the lines of its own vertices to
+// a copy of the file descriptor of out, which may have been opened after D
+// was made. Exits with an error if a worker is unable to write.
+void printDistGraph(FILE* out, DistGraph D);
+
+#endif
@@ -0,0 +1,899 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "ExtBFS.h"
+
+// Number of directed edges sorted in memory at a time while an adjacency
+// file is built, 32MB worth
+#define RUN_EDGES (1L << 22)
+
+// Number of neighbors read from the adjacency file at a time, 4MB worth
+#define WINDOW (1L << 20)
+
+// Most neighbors skipped over to carry on reading the next list of a
+// frontier in the same read, rather than seeking to it
+#define READ_GAP (1L << 14)
+
+// Identifies adjacency files, and the version of their layout
+#define ADJACENCY_MAGIC "BFSADJ02"
+
+// structs --------------------------------------------------------------------
+
+// Private AdjacencyHeader type
+// Start of an adjacency file. It is followed by the offsets of the lists,
+// offset[0..n+1] as longs, where the neighbors of vertex v are entries
+// offset[v] through offset[v+1]-1 of the array of ints that comes last.
+typedef struct AdjacencyHeader {
+    char magic[8];
+    int order;
+    // Whether the identity of the input the file was written from is known,
+    // and if so, that identity
+    int known;
+    long targets;
+    AdjacencySource source;
+} AdjacencyHeader;
+
+typedef struct ExtGraphObj {
+
+    // The adjacency file, and where its array of neighbors starts
+    FILE* file;
+    long data;
+    // The number of vertices of the graph
+    int order;
+    // The header of the file, with the identity of its input
+    AdjacencyHeader header;
+    // Offsets of the adjacency lists in the file, as in the header
+    long* offset;
+    // The neighbors held in memory: entries window[0..windowLength-1] are
+    // entries windowStart onwards of the array in the file
+    int* window;
+    long windowStart;
+    long windowLength;
+    // Array of ints whose ith element is the parent of vertex i
+    int* parent;
+    // Array of ints whose ith element is the distance from the source to
+    // vertex i, or INF while vertex i is undiscovered
+    int* distance;
+    // Array of ints whose ith element is the position of vertex i in the
+    // order BFS() would have discovered its level in
+    int* rank;
+    // The vertices of the current level, and those found on the next,
+    // along with the number of each rank of parent among the latter
+    int* frontier;
+    int* next;
+    int* count;
+    // Vertex that was most recently used as source for extBFS()
+    int source;
+    // State of a search by extBFSTo() from the source, which keeps its
+    // queue in frontier: entries head through tail-1 are still to be
+    // expanded, and the search is over once there are none left. touched
+    // is the number of entries whose vertices have to be reset before the
+    // next search, or -1 if every vertex has to be.
+    int head;
+    int tail;
+    int touched;
+    // Resident cache of adjacency lists for extBFSTo(), or NULL: a ring of
+    // ringSize ints holding each cached list as its vertex, its length and
+    // its neighbors, oldest first from ringTail, with ringUsed of them
+    // taken up. slot[v] is the position of the list of v, or -1.
+    int* ring;
+    long ringSize;
+    long ringHead;
+    long ringTail;
+    long ringUsed;
+    long* slot;
+
+} ExtGraphObj;
+
+// Private helpers ------------------------------------------------------------
+
+// Returns a new array of n elements of the given size. Exits with an
+// error if there isn't enough memory for it.
+static void* extArray(long n, size_t size) {
+
+    void* A = malloc(n * size);
+
+    // Make sure there was memory allocated for the array
+    if(A == NULL) {
+        printf("ExtBFS Error: unable to allocate %ld bytes\n", (long)(n * size));
+        exit(1);
+    }
+
+    return(A);
+}
+
+// Orders ints, or unsigned long longs, for qsort()
+static int compareInts(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return((x > y) - (x < y));
+}
+static int compareEdges(const void* a, const void* b) {
+    unsigned long long x = *(const unsigned long long*)a;
+    unsigned long long y = *(const unsigned long long*)b;
+    return((x > y) - (x < y));
+}
+
+// Records src in the header H as the identity of the input, if it isn't NULL
+static void setSource(AdjacencyHeader* H, AdjacencySource* src) {
+    if(src != NULL) {
+        H->known = 1;
+        H->source = *src;
+    }
+}
+
+// Sorts the count directed edges in E, each stored as u<<32 | v, and writes
+// them to a new temporary file, which is returned rewound
+static FILE* writeRun(unsigned long long* E, long count) {
+
+    FILE* run = tmpfile();
+    qsort(E, count, sizeof(unsigned long long), compareEdges);
+    if(run==NULL || fwrite(E, sizeof(unsigned long long), count, run)!=(size_t)count) {
+        printf("ExtBFS Error: unable to write a temporary file\n");
+        exit(1);
+    }
+    rewind(run);
+    return run;
+}
+
+// Reads count entries of the neighbors in the file, from start on, into A.
+// Reads go straight to the file at their offset, since each is large or
+// lands somewhere new, and a stdio buffer would only copy them twice.
+static void readTargets(ExtGraph E, long start, long count, int* A) {
+
+    char* p = (char*)A;
+    size_t left = count * sizeof(int);
+    off_t at = E->data + start*(long)sizeof(int);
+
+    while(left > 0) {
+        ssize_t got = pread(fileno(E->file), p, left, at);
+        if(got <= 0) {
+            printf("ExtBFS Error: unable to read the adjacency file\n");
+            exit(1);
+        }
+        p += got;
+        at += got;
+        left -= got;
+    }
+}
+
+// Makes entries start through start+count-1 of the neighbors in the file
+// available in the window, reading up to want entries from start if they
+// aren't there already, and returns a pointer to them
+static const int* readNeighbors(ExtGraph E, long start, long count, long want) {
+
+    if(start<E->windowStart || start+count>E->windowStart+E->windowLength) {
+        if(want > WINDOW) {
+            want = WINDOW;
+        }
+        if(want < count) {
+            want = count;
+        }
+        readTargets(E, start, want, E->window);
+        E->windowStart = start;
+        E->windowLength = want;
+    }
+    return(E->window + (start - E->windowStart));
+}
+
+// Drops the oldest list from the cache of E
+static void evictList(ExtGraph E) {
+
+    if(E->ring[E->ringTail] < 0) {
+        // The end of the ring was left unused, so the next list is at 0
+        E->ringUsed -= E->ringSize - E->ringTail;
+        E->ringTail = 0;
+        return;
+    }
+    int v = E->ring[E->ringTail];
+    long length = E->ring[E->ringTail+1] + 2;
+    E->slot[v] = -1;
+    E->ringUsed -= length;
+    E->ringTail += length;
+    if(E->ringTail == E->ringSize) {
+        E->ringTail = 0;
+    }
+}
+
+// Points *adj at the neighbors of v, from the cache of E if they are there,
+// or else read into the cache, evicting the oldest lists to make room, and
+// returns how many there are. The list of v must fit in the cache.
+static int fetchNeighbors(ExtGraph E, int v, const int** adj) {
+
+    int degree = (int)(E->offset[v+1] - E->offset[v]);
+    long need = degree + 2;
+    long pos;
+
+    if(E->slot[v] >= 0) {
+        *adj = E->ring + E->slot[v] + 2;
+        return degree;
+    }
+
+    // Find room for the list after the newest one, wrapping around to
+    // the start of the ring if it doesn't fit before the end
+    while(1) {
+        if(E->ringUsed == 0) {
+            E->ringHead = E->ringTail = 0;
+        }
+        if(E->ringHead>E->ringTail || (E->ringHead==E->ringTail && E->ringUsed==0)) {
+            if(E->ringSize-E->ringHead >= need) {
+                pos = E->ringHead;
+                break;
+            }
+            if(E->ringHead < E->ringSize) {
+                E->ring[E->ringHead] = -1;
+            }
+            E->ringUsed += E->ringSize - E->ringHead;
+            E->ringHead = 0;
+        } else if(E->ringHead<E->ringTail && E->ringTail-E->ringHead>=need) {
+            pos = E->ringHead;
+            break;
+        } else {
+            evictList(E);
+        }
+    }
+
+    // Read the list into its place
+    E->ring[pos] = v;
+    E->ring[pos+1] = degree;
+    readTargets(E, E->offset[v], degree, E->ring+pos+2);
+    E->slot[v] = pos;
+    E->ringHead = pos + need;
+    if(E->ringHead == E->ringSize) {
+        E->ringHead = 0;
+    }
+    E->ringUsed += need;
+
+    *adj = E->ring + pos + 2;
+    return degree;
+}
+
+// Constructors-Destructors ---------------------------------------------------
+
+// Writes the adjacency file at path for the graph of order n whose edges
+// are read from in, one "u v" line per edge up to "0 0", as in the input of
+// FindPath; name is the name of the input and *line the number of its last
+// line read, which is kept up to date for error messages. The edges are
+// sorted by an external merge sort, in runs that fit in a fixed amount of
+// memory, so the graph itself never has to. The file records src as the
+// identity of the input, unless it is NULL. Exits with an error if the
+// input is improper or the file can't be written.
+void buildAdjacencyFile(FILE* in, char* name, int* line, int n, char* path, AdjacencySource* src) {
+
+    int u, v;
+    unsigned long long* E = extArray(RUN_EDGES, sizeof(unsigned long long));
+    long count = 0;
+    FILE** run = NULL;
+    int runs = 0;
+
+    // Read the edges, writing out a sorted run whenever memory is full.
+    // Each edge is stored in both directions, as addEdge() does.
+    while(1) {
+        (*line)++;
+        if(fscanf(in, "%d %d", &u, &v) != 2) {
+            printf("Error in line %d of input %s\n", *line, name);
+            exit(1);
+        }
+        if(u==0 || v==0) {
+            break;
+        }
+        if(u<1 || u>n || v<1 || v>n) {
+            printf("Error in line %d of input %s\n", *line, name);
+            exit(1);
+        }
+        if(count+2 > RUN_EDGES) {
+            run = realloc(run, (runs+1) * sizeof(FILE*));
+            run[runs++] = writeRun(E, count);
+            count = 0;
+        }
+        E[count++] = (unsigned long long)u << 32 | (unsigned int)v;
+        E[count++] = (unsigned long long)v << 32 | (unsigned int)u;
+    }
+
+    // Sort what is left, in memory if everything fit
+    if(runs > 0) {
+        run = realloc(run, (runs+1) * sizeof(FILE*));
+        run[runs++] = writeRun(E, count);
+        count = 0;
+    } else {
+        qsort(E, count, sizeof(unsigned long long), compareEdges);
+    }
+
+    // Open the file, leaving room for the header and offsets
+    FILE* out = fopen(path, "wb");
+    if(out == NULL) {
+        printf("Unable to open file %s for writing\n", path);
+        exit(1);
+    }
+    long* offset = extArray(n+2, sizeof(long));
+    for(int i=0; i<n+2; i++) {
+        offset[i] = 0;
+    }
+    AdjacencyHeader H;
+    memset(&H, 0, sizeof(H));
+    fwrite(&H, sizeof(H), 1, out);
+    fwrite(offset, sizeof(long), n+2, out);
+
+    // Write the neighbors in sorted order, merging the runs if there are any
+    // by taking the smallest head of a run each time
+    long targets = 0;
+    unsigned long long* head = E;
+    int* live = extArray(runs+1, sizeof(int));
+    for(int r=0; r<runs; r++) {
+        live[r] = (fread(&head[r], sizeof(unsigned long long), 1, run[r]) == 1);
+    }
+    for(long i=0; ; i++) {
+        unsigned long long e;
+        if(runs == 0) {
+            if(i == count) {
+                break;
+            }
+            e = E[i];
+        } else {
+            int best = -1;
+            for(int r=0; r<runs; r++) {
+                if(live[r] && (best<0 || head[r]<head[best])) {
+                    best = r;
+                }
+            }
+            if(best < 0) {
+                break;
+            }
+            e = head[best];
+            live[best] = (fread(&head[best], sizeof(unsigned long long), 1, run[best]) == 1);
+        }
+        int target = (int)(e & 0xffffffffu);
+        offset[(e >> 32) + 1]++;
+        fwrite(&target, sizeof(int), 1, out);
+        targets++;
+    }
+    for(int r=0; r<runs; r++) {
+        fclose(run[r]);
+    }
+
+    // Turn the counts into offsets, and go back to fill in the start
+    for(int i=1; i<n+1; i++) {
+        offset[i+1] += offset[i];
+    }
+    offset[0] = 0;
+    memcpy(H.magic, ADJACENCY_MAGIC, sizeof(H.magic));
+    H.order = n;
+    H.targets = targets;
+    setSource(&H, src);
+    fseek(out, 0, SEEK_SET);
+    fwrite(&H, sizeof(H), 1, out);
+    fwrite(offset, sizeof(long), n+2, out);
+    if(ferror(out) || fclose(out)!=0) {
+        printf("Unable to write file %s\n", path);
+        exit(1);
+    }
+
+    free(live);
+    free(run);
+    free(offset);
+    free(E);
+}
+
+// Writes the adjacency lists of the Graph G to an adjacency file at path,
+// laid out as buildAdjacencyFile() lays it out, so that openExtGraph() can
+// search it later without the edges having to be sorted again. Weights are
+// left out. The file records src as the identity of the input G was read
+// from, unless it is NULL. Exits with an error if the file can't be written.
+void writeAdjacencyFile(Graph G, char* path, AdjacencySource* src) {
+
+    // Check if the Graph is NULL
+    if(G == NULL) {
+        printf("ExtBFS Error: calling writeAdjacencyFile() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    int n = getOrder(G);
+    const int* adj;
+    Search S = newSearch(G);
+
+    FILE* out = fopen(path, "wb");
+    if(out == NULL) {
+        printf("Unable to open file %s for writing\n", path);
+        exit(1);
+    }
+
+    // The lists are already sorted, so the offsets are just their
+    // lengths added up
+    long* offset = extArray(n+2, sizeof(long));
+    offset[0] = 0;
+    offset[1] = 0;
+    for(int v=1; v<n+1; v++) {
+        offset[v+1] = offset[v] + searchNeighbors(S, v, &adj);
+    }
+    AdjacencyHeader H;
+    memset(&H, 0, sizeof(H));
+    memcpy(H.magic, ADJACENCY_MAGIC, sizeof(H.magic));
+    H.order = n;
+    H.targets = offset[n+1];
+    setSource(&H, src);
+    fwrite(&H, sizeof(H), 1, out);
+    fwrite(offset, sizeof(long), n+2, out);
+    for(int v=1; v<n+1; v++) {
+        int deg = searchNeighbors(S, v, &adj);
+        fwrite(adj, sizeof(int), deg, out);
+    }
+    if(ferror(out) || fclose(out)!=0) {
+        printf("Unable to write file %s\n", path);
+        exit(1);
+    }
+
+    free(offset);
+    freeSearch(&S);
+}
+
+// Returns an ExtGraph over the adjacency file at path, written by
+// buildAdjacencyFile() or writeAdjacencyFile(), or NULL if it can't be read
+ExtGraph openExtGraph(char* path) {
+
+    AdjacencyHeader H;
+    FILE* in = fopen(path, "rb");
+    if(in == NULL) {
+        return NULL;
+    }
+    if(fread(&H, sizeof(H), 1, in)!=1 || memcmp(H.magic, ADJACENCY_MAGIC, sizeof(H.magic))!=0 || H.order<1) {
+        fclose(in);
+        return NULL;
+    }
+
+    // Allocate memory for the graph
+    ExtGraph E = extArray(1, sizeof(ExtGraphObj));
+    int n = H.order;
+    E->file = in;
+    E->order = n;
+    E->header = H;
+    E->offset = extArray(n+2, sizeof(long));
+    if(fread(E->offset, sizeof(long), n+2, in)!=(size_t)(n+2) || E->offset[n+1]!=H.targets) {
+        fclose(in);
+        free(E->offset);
+        free(E);
+        return NULL;
+    }
+    E->data = sizeof(H) + (n+2)*sizeof(long);
+
+    // Nothing is in the window yet
+    E->window = extArray(WINDOW, sizeof(int));
+    E->windowStart = 0;
+    E->windowLength = 0;
+
+    // Allocate and initialize the state of every vertex
+    E->parent = extArray(n+1, sizeof(int));
+    E->distance = extArray(n+1, sizeof(int));
+    E->rank = extArray(n+1, sizeof(int));
+    E->frontier = extArray(n, sizeof(int));
+    E->next = extArray(n, sizeof(int));
+    E->count = extArray(n+1, sizeof(int));
+    for(int i=1; i<n+1; i++) {
+        E->parent[i] = NIL;
+        E->distance[i] = INF;
+    }
+    E->source = NIL;
+    E->head = E->tail = 0;
+    E->touched = 0;
+
+    // There is no cache until setExtCache() is called
+    E->ring = NULL;
+    E->ringSize = 0;
+    E->ringHead = E->ringTail = E->ringUsed = 0;
+    E->slot = NULL;
+
+    return(E);
+}
+
+// Frees all memory associated with *pE and closes its file,
+// then sets the handle *pE to NULL
+void freeExtGraph(ExtGraph* pE) {
+
+    // Checks if pE or its pointer is NULL
+    if(pE!=NULL && *pE!=NULL) {
+        fclose((*pE)->file);
+        free((*pE)->offset);
+        free((*pE)->window);
+        free((*pE)->parent);
+        free((*pE)->distance);
+        free((*pE)->rank);
+        free((*pE)->frontier);
+        free((*pE)->next);
+        free((*pE)->count);
+        free((*pE)->ring);
+        free((*pE)->slot);
+        free(*pE);
+        *pE = NULL;
+    }
+
+}
+
+// Access functions -----------------------------------------------------------
+
+// Sets *src to the identity of the file at path, reading it from start to
+// end for the checksum. Returns true (1) if it could be read, otherwise
+// false (0).
+int readAdjacencySource(char* path, AdjacencySource* src) {
+
+    struct stat st;
+    FILE* in = fopen(path, "rb");
+    if(in == NULL) {
+        return 0;
+    }
+    if(fstat(fileno(in), &st) != 0) {
+        fclose(in);
+        return 0;
+    }
+    memset(src, 0, sizeof(AdjacencySource));
+    src->size = st.st_size;
+    src->seconds = st.st_mtim.tv_sec;
+    src->nanoseconds = st.st_mtim.tv_nsec;
+
+    // FNV-1a hash of the contents
+    unsigned char buf[1 << 16];
+    size_t got;
+    unsigned long long h = 14695981039346656037ULL;
+    while((got = fread(buf, 1, sizeof(buf), in)) > 0) {
+        for(size_t i=0; i<got; i++) {
+            h = (h ^ buf[i]) * 1099511628211ULL;
+        }
+    }
+    src->checksum = h;
+    int ok = !ferror(in);
+    fclose(in);
+    return ok;
+}
+
+// Returns the number of vertices of E
+int extOrder(ExtGraph E) {
+
+    // Check if this ExtGraph is NULL
+    if(E == NULL) {
+        printf("ExtBFS Error: calling extOrder() on NULL ExtGraph reference\n");
+        exit(1);
+    }
+
+    return(E->order);
+}
+
+// Returns true (1) if the adjacency file of E records src as the identity
+// of the input it was written from, otherwise false (0)
+int extWrittenFrom(ExtGraph E, AdjacencySource* src) {
+
+    // Check if this ExtGraph is NULL
+    if(E == NULL) {
+        printf("ExtBFS Error: calling extWrittenFrom() on NULL ExtGraph reference\n");
+        exit(1);
+    }
+
+    AdjacencySource* had = &E->header.source;
+    return(E->header.known && src!=NULL && had->size==src->size && had->seconds==src->seconds
+           && had->nanoseconds==src->nanoseconds && had->checksum==src->checksum);
+}
+
+// Returns the source of the most recent extBFS(), or NIL if it has not run
+int extSource(ExtGraph E) {
+
+    // Check if this ExtGraph is NULL
+    if(E == NULL) {
+        printf("ExtBFS Error: calling extSource() on NULL ExtGraph reference\n");
+        exit(1);
+    }
+
+    return(E->source);
+}
+
+// Returns the parent of vertex u in the Breadth-First tree created by
+// extBFS(), or NIL if it has not run
+int extParent(ExtGraph E, int u) {
+
+    // Check if this ExtGraph is NULL
+    if(E == NULL) {
+        printf("ExtBFS Error: calling extParent() on NULL ExtGraph reference\n");
+        exit(1);
+    }
+
+    // Check if u is a valid vertex
+    if(u<1 || u>E->order) {
+        printf("ExtBFS Error: extParent() called on improper vertex");
+        exit(1);
+    }
+
+    return(E->parent[u]);
+}
+
+// Returns the distance from the most recent extBFS() source to vertex u,
+// or INF if it has not run
+int extDist(ExtGraph E, int u) {
+
+    // Check if this ExtGraph is NULL
+    if(E == NULL) {
+        printf("ExtBFS Error: calling extDist() on NULL ExtGraph reference\n");
+        exit(1);
+    }
+
+    // Check if u is a valid vertex
+    if(u<1 || u>E->order) {
+        printf("ExtBFS Error: extDist() called on improper vertex");
+        exit(1);
+    }
+
+    return(E->distance[u]);
+}
+
+// Appends to the List L the vertices of a shortest path from the source of
+// the most recent extBFS() to u, or appends NIL if no such path exists
+void extPath(List L, ExtGraph E, int u) {
+
+    // Check if this ExtGraph is NULL
+    if(E == NULL) {
+        printf("ExtBFS Error: calling extPath() on NULL ExtGraph reference\n");
+        exit(1);
+    }
+
+    // Check that extBFS() was called and u is a valid vertex
+    if(E->source==NIL || u<1 || u>E->order) {
+        printf("ExtBFS Error: extPath() called on improper ExtGraph");
+        exit(1);
+    }
+
+    // There is no path if u wasn't reached
+    if(E->distance[u] == INF) {
+        append(L, NIL);
+        return;
+    }
+
+    // Walk back from u to the source, using the next level as room to
+    // hold the path, then append the vertices in reverse
+    int length = E->distance[u];
+    int* path = E->next;
+    for(int i=length, x=u; i>=0; i--, x=E->parent[x]) {
+        path[i] = x;
+    }
+    appendArray(L, path, length+1);
+}
+
+// Manipulation procedures ----------------------------------------------------
+
+// Sets aside a resident cache of room for size neighbors for extBFSTo(),
+// dropping whatever was cached before. The adjacency lists extBFSTo()
+// expands are read into the cache on first use, and the oldest are
+// evicted once it is full; a list too long for the cache is read through
+// on every use.
+void setExtCache(ExtGraph E, long size) {
+
+    // Check if this ExtGraph is NULL
+    if(E == NULL) {
+        printf("ExtBFS Error: calling setExtCache() on NULL ExtGraph reference\n");
+        exit(1);
+    }
+
+    free(E->ring);
+    free(E->slot);
+    E->ring = size>0 ? extArray(size, sizeof(int)) : NULL;
+    E->slot = size>0 ? extArray(E->order+1, sizeof(long)) : NULL;
+    E->ringSize = size>0 ? size : 0;
+    E->ringHead = E->ringTail = E->ringUsed = 0;
+    for(int v=1; v<E->order+1 && size>0; v++) {
+        E->slot[v] = -1;
+    }
+}
+
+// Runs BFS from s over E. Each level is ranked in the order BFS() would have
+// discovered it, so every vertex takes the same parent as it would from
+// BFS(), even though the lists of a level are read in order of label.
+void extBFS(ExtGraph E, int s) {
+
+    // Check if this ExtGraph is NULL
+    if(E == NULL) {
+        printf("ExtBFS Error: calling extBFS() on NULL ExtGraph reference\n");
+        exit(1);
+    }
+
+    // Checks if s is a valid vertex
+    if(s<1 || s>E->order) {
+        printf("ExtBFS Error: extBFS() called on improper source");
+        exit(1);
+    }
+
+    int n = E->order;
+    int* parent = E->parent;
+    int* distance = E->distance;
+    long* offset = E->offset;
+
+    // Every vertex may be reached, and the search runs to the end
+    E->touched = -1;
+    E->head = E->tail = 0;
+
+    // Initialize all parents to NIL and all distances to INF
+    for(int i=1; i<n+1; i++) {
+        parent[i] = NIL;
+        distance[i] = INF;
+    }
+    distance[s] = 0;
+    E->rank[s] = 0;
+    E->source = s;
+
+    // The source alone makes up level 0
+    int size = 1;
+    E->frontier[0] = s;
+
+    for(int d=0; size>0; d++) {
+
+        int found = 0;
+
+        for(int i=0; i<size; i++) {
+
+            // If the list of x has to be read, read ahead over the lists of
+            // the next vertices of the frontier as long as they lie close
+            // together in the file
+            int x = E->frontier[i];
+            long end = offset[x+1];
+            if(offset[x]<E->windowStart || end>E->windowStart+E->windowLength) {
+                for(int j=i+1; j<size && offset[E->frontier[j]]-end<READ_GAP
+                               && offset[E->frontier[j]+1]-offset[x]<=WINDOW; j++) {
+                    end = offset[E->frontier[j]+1];
+                }
+            }
+
+            // Go through the neighbors of x, a window at a time
+            for(long start=offset[x]; start<offset[x+1]; start+=WINDOW) {
+                long count = offset[x+1]-start < WINDOW ? offset[x+1]-start : WINDOW;
+                const int* adj = readNeighbors(E, start, count, end-start);
+                for(long j=0; j<count; j++) {
+                    int y = adj[j];
+                    if(distance[y] == INF) {
+                        // Discover y, with x as its parent for now
+                        distance[y] = d + 1;
+                        parent[y] = x;
+                        E->next[found++] = y;
+                    } else if(distance[y]==d+1 && E->rank[x]<E->rank[parent[y]]) {
+                        // BFS() would have reached y from x first
+                        parent[y] = x;
+                    }
+                }
+            }
+        }
+
+        // The next level is read in order of label: pick its vertices out
+        // of all of them if it is large, or sort them if it is small
+        if(found > n/16) {
+            found = 0;
+            for(int y=1; y<n+1; y++) {
+                if(distance[y] == d+1) {
+                    E->next[found++] = y;
+                }
+            }
+        } else {
+            qsort(E->next, found, sizeof(int), compareInts);
+        }
+
+        // BFS() discovers a level in the order of the parents, and the
+        // children of one parent in the order of their labels, so a stable
+        // counting sort of the level by the rank of the parent ranks it
+        for(int r=0; r<size+1; r++) {
+            E->count[r] = 0;
+        }
+        for(int i=0; i<found; i++) {
+            E->count[E->rank[parent[E->next[i]]] + 1]++;
+        }
+        for(int r=0; r<size; r++) {
+            E->count[r+1] += E->count[r];
+        }
+        for(int i=0; i<found; i++) {
+            int y = E->next[i];
+            E->rank[y] = E->count[E->rank[parent[y]]]++;
+        }
+
+        int* t = E->frontier;
+        E->frontier = E->next;
+        E->next = t;
+        size = found;
+    }
+}
+
+// Runs BFS from s over E only as far as needed to discover t, reading the
+// adjacency lists of the vertices it expands one at a time, through the
+// cache set by setExtCache() if there is one, so a query only reads the
+// part of the file around s. If the most recent search was from s as well,
+// it carries on from where it stopped. The parents and distances found are
+// the same as those of extBFS() and BFS(), for t and every other vertex
+// discovered so far; the rest are INF until a later call discovers them.
+void extBFSTo(ExtGraph E, int s, int t) {
+
+    // Check if this ExtGraph is NULL
+    if(E == NULL) {
+        printf("ExtBFS Error: calling extBFSTo() on NULL ExtGraph reference\n");
+        exit(1);
+    }
+
+    // Checks if s and t are valid vertices
+    if(s<1 || s>E->order || t<1 || t>E->order) {
+        printf("ExtBFS Error: extBFSTo() called on improper vertex");
+        exit(1);
+    }
+
+    int* parent = E->parent;
+    int* distance = E->distance;
+    int* queue = E->frontier;
+
+    // Start over unless this carries on a search from s
+    if(E->source != s) {
+        if(E->touched < 0) {
+            for(int i=1; i<E->order+1; i++) {
+                parent[i] = NIL;
+                distance[i] = INF;
+            }
+        } else {
+            for(int i=0; i<E->touched; i++) {
+                parent[queue[i]] = NIL;
+                distance[queue[i]] = INF;
+            }
+        }
+        E->source = s;
+        distance[s] = 0;
+        queue[0] = s;
+        E->head = 0;
+        E->tail = E->touched = 1;
+    }
+
+    // Expand the queue until t has been discovered
+    while(distance[t]==INF && E->head<E->tail) {
+        int x = queue[E->head++];
+        long first = E->offset[x];
+        long last = E->offset[x+1];
+        const int* adj;
+        long start = first;
+        while(start < last) {
+            long count;
+            if(last-first+2 <= E->ringSize) {
+                count = fetchNeighbors(E, x, &adj);
+            } else {
+                count = last-start < WINDOW ? last-start : WINDOW;
+                adj = readNeighbors(E, start, count, count);
+            }
+            for(long j=0; j<count; j++) {
+                int y = adj[j];
+                if(distance[y] == INF) {
+                    distance[y] = distance[x] + 1;
+                    parent[y] = x;
+                    queue[E->tail++] = y;
+                }
+            }
+            start += count;
+        }
+    }
+
+    // After extBFS() every vertex is still to be reset
+    if(E->touched >= 0) {
+        E->touched = E->tail;
+    }
+}
+
+// Other operations -----------------------------------------------------------
+
+// Prints the adjacency list representation of E to out, in the same form
+// as printGraph(), reading the adjacency file from start to end
+void printExtGraph(FILE* out, ExtGraph E) {
+
+    // Check if this ExtGraph is NULL
+    if(E == NULL) {
+        printf("ExtBFS Error: calling printExtGraph() on NULL ExtGraph reference\n");
+        exit(1);
+    }
+
+    long total = E->offset[E->order+1];
+    for(int v=1; v<E->order+1; v++) {
+        fprintf(out, "%d: ", v);
+        for(long start=E->offset[v]; start<E->offset[v+1]; start+=WINDOW) {
+            long count = E->offset[v+1]-start < WINDOW ? E->offset[v+1]-start : WINDOW;
+            const int* adj = readNeighbors(E, start, count, total-start);
+            for(long j=0; j<count; j++) {
+                fprintf(out, start+j>E->offset[v] ? " %d" : "%d", adj[j]);
+            }
+        }
+        fprintf(out, "\n");
+    }
+}
@@ -0,0 +1,111 @@
+#ifndef _EXTBFS_H_INCLUDE_
+#define _EXTBFS_H_INCLUDE_
+#include <stdio.h>
+#include <stdlib.h>
+#include "Graph.h"
+
+// Exported type --------------------------------------------------------------
+
+// A graph whose adjacency lists stay on disk, for graphs larger than memory.
+// The edges are kept in an adjacency file sorted by vertex, and only a few
+// ints per vertex (parent, distance, the offset of its list in the file and
+// BFS bookkeeping) are held in memory. BFS runs level by level, reading the
+// lists of each frontier, in order of label, in large sequential reads.
+typedef struct ExtGraphObj* ExtGraph;
+
+// Identity of the input file an adjacency file was written from: its size,
+// the time it was last modified, to the nanosecond, and a checksum of its
+// contents, so that the adjacency file is only reused for the same input
+typedef struct AdjacencySource {
+    long size;
+    long seconds;
+    long nanoseconds;
+    unsigned long long checksum;
+} AdjacencySource;
+
+// Constructors-Destructors ---------------------------------------------------
+
+// Writes the adjacency file at path for the graph of order n whose edges
+// are read from in, one "u v" line per edge up to "0 0", as in the input of
+// FindPath; name is the name of the input and *line the number of its last
+// line read, which is kept up to date for error messages. The edges are
+// sorted by an external merge sort, in runs that fit in a fixed amount of
+// memory, so the graph itself never has to. The file records src as the
+// identity of the input, unless it is NULL. Exits with an error if the
+// input is improper or the file can't be written.
+void buildAdjacencyFile(FILE* in, char* name, int* line, int n, char* path, AdjacencySource* src);
+
+// Writes the adjacency lists of the Graph G to an adjacency file at path,
+// laid out as buildAdjacencyFile() lays it out, so that openExtGraph() can
+// search it later without the edges having to be sorted again. Weights are
+// left out. The file records src as the identity of the input G was read
+// from, unless it is NULL. Exits with an error if the file can't be written.
+void writeAdjacencyFile(Graph G, char* path, AdjacencySource* src);
+
+// Returns an ExtGraph over the adjacency file at path, written by
+// buildAdjacencyFile() or writeAdjacencyFile(), or NULL if it can't be read
+ExtGraph openExtGraph(char* path);
+
+// Frees all memory associated with *pE and closes its file,
+// then sets the handle *pE to NULL
+void freeExtGraph(ExtGraph* pE);
+
+// Access functions -----------------------------------------------------------
+
+// Sets *src to the identity of the file at path, reading it from start to
+// end for the checksum. Returns true (1) if it could be read, otherwise
+// false (0).
+int readAdjacencySource(char* path, AdjacencySource* src);
+
+// Returns the number of vertices of E
+int extOrder(ExtGraph E);
+
+// Returns true (1) if the adjacency file of E records src as the identity
+// of the input it was written from, otherwise false (0)
+int extWrittenFrom(ExtGraph E, AdjacencySource* src);
+
+// Returns the source of the most recent extBFS(), or NIL if it has not run
+int extSource(ExtGraph E);
+
+// Returns the parent of vertex u in the Breadth-First tree created by
+// extBFS(), or NIL if it has not run
+int extParent(ExtGraph E, int u);
+
+// Returns the distance from the most recent extBFS() source to vertex u,
+// or INF if it has not run
+int extDist(ExtGraph E, int u);
+
+// Appends to the List L the vertices of a shortest path from the source of
+// the most recent extBFS() to u, or appends NIL if no such path exists
+void extPath(List L, ExtGraph E, int u);
+
+// Manipulation procedures ----------------------------------------------------
+
+// Sets aside a resident cache of room for size neighbors for extBFSTo(),
+// dropping whatever was cached before. The adjacency lists extBFSTo()
+// expands are read into the cache on first use, and the oldest are
+// evicted once it is full; a list too long for the cache is read through
+// on every use.
+void setExtCache(ExtGraph E, long size);
+
+// Runs BFS from s over E. Each level is ranked in the order BFS() would have
+// discovered it, so every vertex takes the same parent as it would from
+// BFS(), even though the lists of a level are read in order of label.
+void extBFS(ExtGraph E, int s);
+
+// Runs BFS from s over E only as far as needed to discover t, reading the
+// adjacency lists of the vertices it expands one at a time, through the
+// cache set by setExtCache() if there is one, so a query only reads the
+// part of the file around s. If the most recent search was from s as well,
+// it carries on from where it stopped. The parents and distances found are
+// the same as those of extBFS() and BFS(), for t and every other vertex
+// discovered so far; the rest are INF until a later call discovers them.
+void extBFSTo(ExtGraph E, int s, int t);
+
+// Other operations -----------------------------------------------------------
+
+// Prints the adjacency list representation of E to out, in the same form
+// as printGraph(), reading the adjacency file from start to end
+void printExtGraph(FILE* out, ExtGraph E);
+
+#endif
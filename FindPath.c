@@ -1,116 +1,1948 @@
+#define _POSIX_C_SOURCE 200809L
 #include<stdio.h>
 #include<stdlib.h>
 #include<string.h>
+#include<limits.h>
+#include<signal.h>
+#include<unistd.h>
+#include<poll.h>
+#include<sys/socket.h>
+#include<sys/un.h>
+#include<fcntl.h>
+#include<pthread.h>
+#include<zlib.h>
 #include"Graph.h"
+#include"Centrality.h"
+#include"Diameter.h"
+#include"Sketch.h"
+#include"DistBFS.h"
+#include"ExtBFS.h"
 
-int main(int argc, char * argv[]) {
+// Size of the buffer used to read streamed queries
+#define STREAM_BUFFER 65536
 
-    FILE *in, *out;
-    int n, u ,v, i, sor, des;
-    
+// Number of queries read from the input file and answered at a time
+#define QUERY_BLOCK 4096
 
-    // Check command line for correct number of arguments
-    if( argc != 3 ){
-        printf("Usage: %s <input file> <output file>\n", argv[0]);
-        exit(1);
-    }
+// Size of the blocks the pipelined mode reads the input file in, and the
+// number of them it has in flight at a time
+#define PIPE_CHUNK (1L << 22)
+#define PIPE_SLOTS 8
 
-    // Open files for reading and writing 
-    in = fopen(argv[1], "r");
-    out = fopen(argv[2], "w");
-    if( in==NULL ){
-        printf("Unable to open file %s for reading\n", argv[1]);
-        exit(1);
-    }
-    if( out==NULL ){
-        printf("Unable to open file %s for writing\n", argv[2]);
-        exit(1);
-    }
+// Parts of the output, for -m
+#define OUTPUT_GRAPH 1
+#define OUTPUT_QUERIES 2
+
+// Formats of the adjacency lists written to a file of their own, for -f
+#define DUMP_TEXT 0
+#define DUMP_BINARY 1
+#define DUMP_GZIP 2
+
+// States of a block in the pipelined mode: free, read from the file and
+// waiting to be parsed, and parsed
+#define CHUNK_EMPTY 0
+#define CHUNK_READ 1
+#define CHUNK_PARSED 2
+
+// Options that control how queries are answered
+typedef struct Options {
+    // Depth limit for k-hop queries, or -1 to search the whole graph
+    int depth;
+    // Stream queries from stdin to stdout instead of using an output file
+    int stream;
+    // Path of the Unix socket to serve queries on, or NULL
+    char* socket;
+    // Number of streamed answers written before the output is flushed
+    int batch;
+    // Number of worker threads answering queries
+    int threads;
+    // Compress the adjacency lists once the graph is loaded
+    int compress;
+    // Allocation policy of the graph arrays (see Memory.h)
+    int policy;
+    // Edges carry weights and paths are shortest by total weight
+    int weighted;
+    // Directory of saved search results to reuse, or NULL
+    char* cache;
+    // Drop duplicate edges and self-loops as the graph is loaded
+    int dedup;
+    // Number of sources to sample for centrality, 0 for all of them,
+    // or -1 not to compute centrality
+    int samples;
+    // Count the shortest paths of each query, and also list them all
+    int count;
+    int enumerate;
+    // Number of worker processes to split the graph over, or 0 to
+    // load it in this process
+    int procs;
+    // Path of the adjacency file to search the graph on disk through,
+    // or NULL to load it into memory
+    char* external;
+    // Number of neighbors kept in memory for -x queries that only read the
+    // graph as far as they need to, or -1 to search it a level at a time
+    long resident;
+    // Answer each query by a BFS from both of its ends at once
+    int between;
+    // Print the diameter and radius of the graph after the answers
+    int diameter;
+    // Number of landmarks to sketch the distances from, or 0, and the
+    // sketch once it is built
+    int landmarks;
+    Sketch sketch;
+    // Read, parse, load and answer the input file all at once
+    int pipelined;
+    // Parts of the output to write, OUTPUT_GRAPH and OUTPUT_QUERIES
+    int output;
+    // File to write the adjacency lists to instead of the output file,
+    // or NULL, and the format to write them in
+    char* dump;
+    int format;
+    // Name of the input file, which a binary dump records as its source
+    char* input;
+    // Most bytes the graph and its searches may hold, or 0 for no limit,
+    // and whether to report the memory they hold at the end
+    long budget;
+    int report;
+} Options;
+
+// One query together with its answer
+typedef struct Answer {
+    int sor;
+    int des;
+    // Distance from sor to des, or INF if there is no path
+    int dist;
+    // Number of vertices within the depth limit of sor in k-hop mode
+    int reached;
+    // Number of shortest paths from sor to des, when they are counted
+    unsigned long long paths;
+    // A shortest path from sor to des
+    List path;
+} Answer;
+
+// Pool of worker threads, each with its own Search over the shared Graph,
+// that answers a batch of queries at a time. Answers are stored in the
+// batch by position, so the output order doesn't depend on which worker
+// finishes first.
+typedef struct Pool {
+    pthread_t* thread;
+    Graph graph;
+    int threads;
+    Options* opt;
+    pthread_mutex_t lock;
+    // Signalled when a new batch is ready and when a batch is done
+    pthread_cond_t start;
+    pthread_cond_t done;
+    // The current batch, the next query to hand out, and the number answered
+    Answer* work;
+    int count;
+    int next;
+    int finished;
+    // Incremented for every batch, so workers can tell a new one has arrived
+    int round;
+    int quit;
+} Pool;
+
+// Argument handed to each worker thread
+typedef struct Worker {
+    Pool* pool;
+    int id;
+} Worker;
+
+// Reads the first part of the input file (the order followed by edges and
+// terminated by "0 0") and returns the Graph it describes, allocated with
+// the policy in opt. In weighted mode each edge is followed by its weight.
+// The line counter *line is left on the terminating line.
+Graph readGraph(FILE* in, char* name, int* line, Options* opt) {
+
+    int n, u, v, w;
 
     // Get the order and make sure there is only one argument
     if( fscanf(in, "%d", &n) != 1) {
-        printf("Error in first line of input %s\n", argv[1]);
+        printf("Error in first line of input %s\n", name);
         exit(1);
     }
 
     // Initialize Graph G of order n
-    Graph G = newGraph(n);
+    Graph G = newGraphPolicy(n, opt->policy);
+    setDedup(G, opt->dedup);
+    if(opt->budget > 0) {
+        setMemoryBudget(G, opt->budget);
+    }
 
     // Get first edge and make sure there are two arguments
     if(fscanf(in, "%d %d", &u, &v) != 2) {
-        printf("Error in second line of input %s\n", argv[1]);
+        printf("Error in second line of input %s\n", name);
         exit(1);
     }
 
     // Set line counter equal to 2
-    i = 2;
+    *line = 2;
 
     // Run loop while the vertices inputted don't point to 0
     while(u!=0 && v!=0) {
-        // Add edge to the Graph
-        addEdge(G,u,v);
+        // Add edge to the Graph, reading its weight first in weighted mode
+        if(opt->weighted) {
+            if(fscanf(in, "%d", &w) != 1 || w < 0) {
+                printf("Error in line %d of input %s\n", *line, name);
+                exit(1);
+            }
+            addWeightedEdge(G,u,v,w);
+        } else {
+            addEdge(G,u,v);
+        }
         // Increment line counter
-        i++;
+        (*line)++;
         // Get next edge and make sure there are two arguments
         if(fscanf(in, "%d %d", &u, &v) != 2) {
-        printf("Error in line %d of input %s\n", i, argv[1]);
-        exit(1);
+            printf("Error in line %d of input %s\n", *line, name);
+            exit(1);
         }
     }
 
-    printGraph(out,G);
+    // Report how much of the input was left out
+    if(opt->dedup) {
+        fprintf(stderr, "Dropped %d duplicate edges and self-loops from %s\n", getDropped(G), name);
+    }
 
-    // Incremenet line counter
-    i++;
+    return G;
+}
 
-    // Get first path and make sure there are two arguments
-    if(fscanf(in, "%d %d", &sor, &des) != 2) {
-        printf("Error in line %d of input %s\n", i, argv[1]);
-        exit(1);
+// Answers the query A using the Search S
+void solveQuery(Search S, Answer* A, Options* opt) {
+
+    // Name the saved result for this source in the cache directory, which
+    // depends on the kind of search as well
+    char path[4096];
+    int cached = 0;
+
+    // The landmarks answer without searching if they pin the distance down
+    if(opt->sketch != NULL) {
+        A->dist = sketchPath(opt->sketch, S, A->sor, A->des, A->path);
+        if(A->dist != SKETCH_UNKNOWN) {
+            A->reached = 0;
+            return;
+        }
     }
 
-    // Create new List L
-    List L = newList();
+    // A search from both ends meets in the middle, and gives the path
+    // and distance without any levels to count
+    if(opt->between) {
+        A->dist = searchBetween(S, A->sor, A->des, A->path);
+        A->reached = 0;
+        return;
+    }
+    if(opt->cache!=NULL && !opt->count) {
+        if(opt->weighted) {
+            snprintf(path, sizeof(path), "%s/sp-%d.bin", opt->cache, A->sor);
+        } else if(opt->depth >= 0) {
+            snprintf(path, sizeof(path), "%s/hop%d-%d.bin", opt->cache, opt->depth, A->sor);
+        } else {
+            snprintf(path, sizeof(path), "%s/bfs-%d.bin", opt->cache, A->sor);
+        }
+        cached = loadSearch(S, path);
+    }
 
-    // Run loop while the paths inputted don't point to 0
-    while(sor!=0 && des!=0) {
-        // Call BFS on source sor
-        BFS(G,sor);
+    // Call BFS on source sor, stopping at the depth limit if there is one,
+    // or find the paths of least weight in weighted mode, unless the
+    // result was saved already
+    if(!cached) {
+        if(opt->weighted) {
+            searchWeighted(S,A->sor);
+        } else if(opt->count) {
+            searchCount(S,A->sor);
+            A->paths = searchPathCount(S,A->des);
+        } else if(opt->depth >= 0) {
+            searchDepth(S,A->sor,opt->depth);
+        } else if(opt->cache != NULL) {
+            searchBFS(S,A->sor);
+        } else {
+            // Only the path to des is wanted, so stop once des is found,
+            // unless the whole result is to be saved
+            searchVisit(S,A->sor,-1,stopAtVertex,NULL,&A->des);
+        }
+        if(opt->cache!=NULL && !opt->count && !saveSearch(S, path)) {
+            fprintf(stderr, "Unable to save search result to %s\n", path);
+        }
+    }
+
+    // Get path from source to destination
+    searchPath(A->path,S,A->des);
 
-        // Get path from source to destination
-        getPath(L,G,des);
+    // Get distance from source to destination
+    A->dist = searchDist(S,A->des);
+
+    // Count the vertices within the depth limit
+    A->reached = 0;
+    for(int d=0; d<searchLevels(S); d++) {
+        A->reached += searchLevelSize(S,d);
+    }
+}
 
-        // Get distance from source to destination
-        int dist = getDist(G,des);
+// Prints the answer A to out and empties its path List
+void printAnswer(FILE* out, Answer* A, Options* opt) {
 
-        // If the distance is infinity, print out the messages accordingly
-        if(dist == INF) {
-            fprintf(out, "\nThe distance from %d to %d is infinity\n", sor, des);
-            fprintf(out, "No %d-%d path exists", sor, des);
+    int sor = A->sor;
+    int des = A->des;
 
-        // Else, print out the distance along with the shortest path
+    // In k-hop mode, report the size of the neighborhood and whether
+    // the destination lies inside it
+    if(opt->depth >= 0) {
+        fprintf(out, "\n%d vertices are within %d hops of %d\n", A->reached, opt->depth, sor);
+        if(A->dist == INF) {
+            fprintf(out, "No %d-%d path of length at most %d exists", sor, des, opt->depth);
         } else {
-            fprintf(out, "\nThe distance from %d to %d is %d\n", sor, des, dist);
+            fprintf(out, "The distance from %d to %d is %d\n", sor, des, A->dist);
             fprintf(out, "A shortest %d-%d path is: ", sor, des);
-            printList(out,L);
+            printList(out,A->path);
         }
+
+    // If the distance is infinity, print out the messages accordingly
+    } else if(A->dist == INF) {
+        fprintf(out, "\nThe distance from %d to %d is infinity\n", sor, des);
+        fprintf(out, "No %d-%d path exists", sor, des);
+
+    // Else, print out the distance along with the shortest path
+    } else {
+        fprintf(out, "\nThe distance from %d to %d is %d\n", sor, des, A->dist);
+        fprintf(out, "A shortest %d-%d path is: ", sor, des);
+        printList(out,A->path);
+        if(opt->count) {
+            fprintf(out, "\nThe number of shortest %d-%d paths is %s%llu", sor, des,
+                    A->paths==ULLONG_MAX ? "at least " : "", A->paths);
+        }
+    }
+    fprintf(out, "\n");
+
+    // Clear the List after every answer
+    clear(A->path);
+}
+
+// Prints every shortest path of the query A found by the Search S, one
+// per line, walking through them without holding more than one at a time
+void printAllPaths(FILE* out, Search S, Answer* A) {
+
+    PathIterator I = newPathIterator(S, A->des);
+
+    fprintf(out, "All shortest %d-%d paths are:\n", A->sor, A->des);
+    while(nextPath(I, A->path)) {
+        printList(out, A->path);
         fprintf(out, "\n");
+        clear(A->path);
+    }
+
+    freePathIterator(&I);
+}
+
+// Body of each worker thread: waits for a batch, answers queries from it
+// until none are left, and repeats until the pool is shut down.
+void* workerMain(void* arg) {
+
+    Worker* W = arg;
+    Pool* P = W->pool;
+    int seen = 0;
+
+    // Create the Search here rather than in newPool(), so that its
+    // pages are first touched, and so placed, by the thread using it
+    Search S = newSearch(P->graph);
 
-        // Clear the List after every iteration
-        clear(L);
+    pthread_mutex_lock(&P->lock);
+    while(1) {
+        // Wait for a batch this worker hasn't seen yet
+        while(P->round==seen && !P->quit) {
+            pthread_cond_wait(&P->start, &P->lock);
+        }
+        if(P->quit) {
+            break;
+        }
+        seen = P->round;
+
+        // Take one query at a time and answer it outside the lock
+        while(P->next < P->count) {
+            Answer* A = &P->work[P->next++];
+            pthread_mutex_unlock(&P->lock);
+            solveQuery(S, A, P->opt);
+            pthread_mutex_lock(&P->lock);
+            if(++P->finished == P->count) {
+                pthread_cond_signal(&P->done);
+            }
+        }
+    }
+    pthread_mutex_unlock(&P->lock);
+
+    freeSearch(&S);
+    free(W);
+    return NULL;
+}
+
+// Returns a new Pool of opt->threads workers over the Graph G
+Pool* newPool(Graph G, Options* opt) {
+
+    Pool* P = malloc(sizeof(Pool));
+    P->threads = opt->threads;
+    P->opt = opt;
+    P->graph = G;
+    P->thread = malloc(P->threads * sizeof(pthread_t));
+    pthread_mutex_init(&P->lock, NULL);
+    pthread_cond_init(&P->start, NULL);
+    pthread_cond_init(&P->done, NULL);
+    P->work = NULL;
+    P->count = P->next = P->finished = 0;
+    P->round = 0;
+    P->quit = 0;
+
+    // Start the workers
+    for(int t=0; t<P->threads; t++) {
+        Worker* W = malloc(sizeof(Worker));
+        W->pool = P;
+        W->id = t;
+        if(pthread_create(&P->thread[t], NULL, workerMain, W) != 0) {
+            printf("Unable to start worker thread %d\n", t);
+            exit(1);
+        }
+    }
+
+    return P;
+}
+
+// Stops the workers of *pP and frees the Pool
+void freePool(Pool** pP) {
+
+    if(pP!=NULL && *pP!=NULL) {
+        Pool* P = *pP;
+        pthread_mutex_lock(&P->lock);
+        P->quit = 1;
+        pthread_cond_broadcast(&P->start);
+        pthread_mutex_unlock(&P->lock);
+        for(int t=0; t<P->threads; t++) {
+            pthread_join(P->thread[t], NULL);
+        }
+        pthread_mutex_destroy(&P->lock);
+        pthread_cond_destroy(&P->start);
+        pthread_cond_destroy(&P->done);
+        free(P->thread);
+        free(P);
+        *pP = NULL;
+    }
+}
+
+// Answers the count queries in work, on the Pool P if there is one
+// and otherwise with the Graph's own Search
+void solveBatch(Graph G, Pool* P, Answer* work, int count, Options* opt) {
+
+    if(P == NULL) {
+        for(int q=0; q<count; q++) {
+            solveQuery(getSearch(G), &work[q], opt);
+        }
+    } else {
+        // Hand the batch to the workers and wait for all of it to be answered
+        pthread_mutex_lock(&P->lock);
+        P->work = work;
+        P->count = count;
+        P->next = 0;
+        P->finished = 0;
+        P->round++;
+        pthread_cond_broadcast(&P->start);
+        while(P->finished < count) {
+            pthread_cond_wait(&P->done, &P->lock);
+        }
+        pthread_mutex_unlock(&P->lock);
+    }
+}
+
+// Answers the count queries in work, on the Pool P if there is one
+// and otherwise with the Graph's own Search, and prints them in order.
+void answerBatch(FILE* out, Graph G, Pool* P, Answer* work, int count, Options* opt) {
+
+    if(P == NULL) {
+        // Print each answer as soon as it is found, while the Search
+        // still holds every shortest path of the query
+        for(int q=0; q<count; q++) {
+            solveQuery(getSearch(G), &work[q], opt);
+            printAnswer(out, &work[q], opt);
+            if(opt->enumerate && work[q].dist!=INF) {
+                printAllPaths(out, getSearch(G), &work[q]);
+            }
+        }
+    } else {
+        solveBatch(G, P, work, count, opt);
+        for(int q=0; q<count; q++) {
+            printAnswer(out, &work[q], opt);
+        }
+    }
+}
+
+// Prints the closeness and betweenness centrality of every vertex of G
+// to out, one vertex per line, searching from opt->samples sources (or
+// all of them if it is 0) on opt->threads threads
+void printCentrality(FILE* out, Graph G, Options* opt) {
+
+    int n = getOrder(G);
+    double* closeness = newGraphArray(G, MEMORY_SCRATCH, n+1, sizeof(double));
+    double* betweenness = newGraphArray(G, MEMORY_SCRATCH, n+1, sizeof(double));
+
+    centrality(G, closeness, betweenness, opt->samples, opt->threads);
+
+    fprintf(out, "\nCloseness and betweenness centrality");
+    if(opt->samples>0 && opt->samples<n) {
+        fprintf(out, ", estimated from %d sources", opt->samples);
+    }
+    fprintf(out, ":\n");
+    for(int v=1; v<n+1; v++) {
+        fprintf(out, "%d: %.6f %.6f\n", v, closeness[v], betweenness[v]);
+    }
+
+    freeGraphArray(G, MEMORY_SCRATCH, closeness);
+    freeGraphArray(G, MEMORY_SCRATCH, betweenness);
+}
+
+// Last bounds reported by reportBounds(), and what they are bounds on
+typedef struct Bounds {
+    const char* name;
+    int lower;
+    int upper;
+} Bounds;
+
+// Progress function for diameter() and radius() that reports the bounds
+// on stderr whenever they change
+void reportBounds(void* context, int lower, int upper, int searches) {
+
+    Bounds* B = context;
+
+    if(lower!=B->lower || upper!=B->upper) {
+        fprintf(stderr, "The %s is between %d and %d after %d searches\n", B->name, lower, upper, searches);
+        B->lower = lower;
+        B->upper = upper;
+    }
+}
+
+// Prints the diameter and radius of G to out, counting edges, along with
+// the narrowest unsigned type that holds every distance in G and the
+// INF that marks unreached vertices
+void printDiameter(FILE* out, Graph G) {
+
+    Eccentricity E = newEccentricity(G);
+    Bounds B = { "diameter", diameterLower(E), diameterUpper(E) };
+
+    setEccProgress(E, reportBounds, &B);
+    int d = diameter(E);
+    B.name = "radius";
+    B.lower = radiusLower(E);
+    B.upper = radiusUpper(E);
+    int r = radius(E);
+
+    int bits = 8;
+    while(bits<32 && d >= (1L<<bits) - 1) {
+        bits *= 2;
+    }
+    fprintf(out, "\nThe diameter is %d and the radius is %d, found with %d searches\n", d, r, eccSearches(E));
+    fprintf(out, "Every distance fits in %d bits\n", bits);
+
+    freeEccentricity(&E);
+}
+
+// Returns the number of bytes written in text, a whole number optionally
+// followed by K, M or G for units of 1024, 1024^2 or 1024^3 bytes, or -1
+// if it isn't one
+long parseBytes(char* text) {
+
+    char* end;
+    long bytes = strtol(text, &end, 10);
+    long unit = 1;
+    if(end == text || bytes < 0) {
+        return -1;
+    }
+    if(*end=='K' || *end=='k') {
+        unit = 1L << 10;
+    } else if(*end=='M' || *end=='m') {
+        unit = 1L << 20;
+    } else if(*end=='G' || *end=='g') {
+        unit = 1L << 30;
+    }
+    if(unit > 1) {
+        end++;
+    }
+    if(*end!='\0' || bytes > LONG_MAX/unit) {
+        return -1;
+    }
+    return(bytes * unit);
+}
+
+// Compresses G if the CSR index that searching it needs wouldn't fit in
+// the memory budget next to its adjacency Lists, since the compressed
+// lists take the place of both in a fraction of the room
+void fitBudget(Graph G, Options* opt) {
+
+    long index = getIndexBytes(G);
+    if(opt->budget>0 && index>0 && getMemory(G, MEMORY_KINDS)+index>opt->budget) {
+        fprintf(stderr, "The index of the graph wouldn't fit in the memory budget, compressing the graph\n");
+        compressGraph(G);
+    }
+}
+
+// Prints to out how much memory G and its Searches hold, of each kind and
+// in all, and the most they have held at once
+void printMemory(FILE* out, Graph G, Options* opt) {
+
+    fprintf(out, "Memory: %ld bytes of adjacency, %ld of per-vertex state, %ld of scratch, %ld in all\n",
+            getMemory(G, MEMORY_ADJACENCY), getMemory(G, MEMORY_VERTEX),
+            getMemory(G, MEMORY_SCRATCH), getMemory(G, MEMORY_KINDS));
+    fprintf(out, "Memory: at most %ld bytes held at once", getMemoryPeak(G));
+    if(opt->budget > 0) {
+        fprintf(out, ", of a budget of %ld", opt->budget);
+    }
+    fprintf(out, "\n");
+}
+
+// Writes the adjacency lists of G as text, gzip compressed, to the file at
+// path. The text goes through a temporary file, since printGraph() only
+// writes to a stream. Returns false (0) if either file fails.
+int gzipGraph(Graph G, char* path) {
+
+    FILE* tmp = tmpfile();
+    if(tmp == NULL) {
+        return 0;
+    }
+    printGraph(tmp, G);
+    if(fflush(tmp)!=0 || fseek(tmp, 0, SEEK_SET)!=0) {
+        fclose(tmp);
+        return 0;
+    }
+
+    gzFile z = gzopen(path, "wb");
+    if(z == NULL) {
+        fclose(tmp);
+        return 0;
+    }
+    char buf[STREAM_BUFFER];
+    size_t got;
+    int ok = 1;
+    while(ok && (got = fread(buf, 1, sizeof(buf), tmp)) > 0) {
+        ok = gzwrite(z, buf, got)==(int)got;
+    }
+    ok = !ferror(tmp) && ok;
+    ok = (gzclose(z)==Z_OK) && ok;
+    fclose(tmp);
+    return ok;
+}
+
+// Writes the adjacency lists of G as text to out, or to the file
+// opt->dump in the format opt->format, unless they aren't wanted
+void dumpGraph(FILE* out, Graph G, Options* opt) {
+
+    if(!(opt->output & OUTPUT_GRAPH)) {
+        return;
+    }
+    if(opt->dump == NULL) {
+        printGraph(out, G);
+        return;
+    }
+    if(opt->format == DUMP_BINARY) {
+        AdjacencySource src;
+        int known = opt->input!=NULL && readAdjacencySource(opt->input, &src);
+        writeAdjacencyFile(G, opt->dump, known ? &src : NULL);
+        return;
+    }
+
+    if(opt->format == DUMP_GZIP) {
+        if(!gzipGraph(G, opt->dump)) {
+            printf("Unable to write file %s\n", opt->dump);
+            exit(1);
+        }
+        return;
+    }
+
+    FILE* f = fopen(opt->dump, "w");
+    if(f == NULL) {
+        printf("Unable to open file %s for writing\n", opt->dump);
+        exit(1);
+    }
+    printGraph(f, G);
+    if(ferror(f) | (fclose(f)!=0)) {
+        printf("Unable to write file %s\n", opt->dump);
+        exit(1);
+    }
+}
+
+// Answers the queries in the input file in, named name, with the graph
+// split over opt->procs worker processes, each of which reads its own part
+// of the graph from the file, and writes everything to out
+void answerDistributed(FILE* in, FILE* out, char* name, Options* opt) {
+
+    int n, u, v;
+    int line = 1;
+    Answer A;
+
+    // The workers read the graph themselves, so just skip past it here
+    DistGraph D = newDistGraph(name, opt->procs, opt->policy);
+    if(fscanf(in, "%d", &n) != 1) {
+        printf("Error in first line of input %s\n", name);
+        exit(1);
+    }
+    do {
+        line++;
+        if(fscanf(in, "%d %d", &u, &v) != 2) {
+            printf("Error in line %d of input %s\n", line, name);
+            exit(1);
+        }
+    } while(u!=0 && v!=0);
+
+    if(opt->output & OUTPUT_GRAPH) {
+        printDistGraph(out, D);
+    }
+    if(!(opt->output & OUTPUT_QUERIES)) {
+        freeDistGraph(&D);
+        return;
+    }
+
+    // Answer each query in turn, searching again only for a new source
+    A.path = newList();
+    while(1) {
+        line++;
+        if(fscanf(in, " %d %d", &A.sor, &A.des) != 2) {
+            printf("Error in line %d of input %s\n", line, name);
+            exit(1);
+        }
+        if(A.sor==0 || A.des==0) {
+            break;
+        }
+        if(A.sor<1 || A.sor>n || A.des<1 || A.des>n) {
+            printf("Error in line %d of input %s\n", line, name);
+            exit(1);
+        }
+        if(distSource(D) != A.sor) {
+            distBFS(D, A.sor);
+        }
+        distPath(A.path, D, A.des);
+        A.dist = distDist(D, A.des);
+        printAnswer(out, &A, opt);
+    }
+
+    freeList(&A.path);
+    freeDistGraph(&D);
+}
+
+// Answers the queries in the input file in, named name, with the graph kept
+// on disk in the adjacency file opt->external. The file is written from the
+// edges of the input unless it is already there and was written from this
+// very input, the same size, modification time and checksum, in which case
+// the edges are skipped and the file reused. Writes everything to out.
+void answerExternal(FILE* in, FILE* out, char* name, Options* opt) {
+
+    int n, u, v;
+    int line = 1;
+    AdjacencySource src;
+    Answer A;
+
+    if(fscanf(in, "%d", &n) != 1 || n < 1) {
+        printf("Error in first line of input %s\n", name);
+        exit(1);
+    }
+
+    // Sort the edges into the adjacency file, or skip past them if the
+    // file was written from this input before
+    int known = readAdjacencySource(name, &src);
+    ExtGraph E = known ? openExtGraph(opt->external) : NULL;
+    if(E!=NULL && extOrder(E)==n && extWrittenFrom(E, &src)) {
+        do {
+            line++;
+            if(fscanf(in, "%d %d", &u, &v) != 2) {
+                printf("Error in line %d of input %s\n", line, name);
+                exit(1);
+            }
+        } while(u!=0 && v!=0);
+    } else {
+        freeExtGraph(&E);
+        buildAdjacencyFile(in, name, &line, n, opt->external, known ? &src : NULL);
+        E = openExtGraph(opt->external);
+        if(E == NULL) {
+            printf("Unable to read file %s\n", opt->external);
+            exit(1);
+        }
+    }
+
+    if(opt->output & OUTPUT_GRAPH) {
+        printExtGraph(out, E);
+    }
+    if(!(opt->output & OUTPUT_QUERIES)) {
+        freeExtGraph(&E);
+        return;
+    }
+    if(opt->resident >= 0) {
+        setExtCache(E, opt->resident);
+    }
+
+    // Answer each query in turn, searching again only for a new source,
+    // or only as far as the destination if the graph is read lazily
+    A.path = newList();
+    while(1) {
+        line++;
+        if(fscanf(in, " %d %d", &A.sor, &A.des) != 2) {
+            printf("Error in line %d of input %s\n", line, name);
+            exit(1);
+        }
+        if(A.sor==0 || A.des==0) {
+            break;
+        }
+        if(A.sor<1 || A.sor>n || A.des<1 || A.des>n) {
+            printf("Error in line %d of input %s\n", line, name);
+            exit(1);
+        }
+        if(opt->resident >= 0) {
+            extBFSTo(E, A.sor, A.des);
+        } else if(extSource(E) != A.sor) {
+            extBFS(E, A.sor);
+        }
+        extPath(A.path, E, A.des);
+        A.dist = extDist(E, A.des);
+        printAnswer(out, &A, opt);
+    }
+
+    freeList(&A.path);
+    freeExtGraph(&E);
+}
+
+// Returns an array of n Answers, each with an empty path List
+Answer* newAnswers(int n) {
+    Answer* work = malloc(n * sizeof(Answer));
+    for(int q=0; q<n; q++) {
+        work[q].path = newList();
+    }
+    return work;
+}
+
+// Frees the array of n Answers *pW and sets *pW to NULL
+void freeAnswers(Answer** pW, int n) {
+    if(pW!=NULL && *pW!=NULL) {
+        for(int q=0; q<n; q++) {
+            freeList(&(*pW)[q].path);
+        }
+        free(*pW);
+        *pW = NULL;
+    }
+}
+
+// Server state shared by the streaming functions
+typedef struct Server {
+    Graph G;
+    Pool* pool;
+    Options* opt;
+    // Queries read but not answered yet
+    Answer* work;
+    int count;
+    // Edge changes read but not applied yet, as for updateEdges()
+    List add;
+    List weights;
+    List remove;
+} Server;
+
+// Applies every edge change the Server has queued up to its Graph
+void applyUpdates(Server* V) {
+    if(length(V->add)>0 || length(V->remove)>0) {
+        updateEdges(V->G, V->add, V->opt->weighted ? V->weights : NULL, V->remove);
+        clear(V->add);
+        clear(V->weights);
+        clear(V->remove);
+    }
+}
+
+// Answers and writes out every query the Server has queued up
+void runQueued(FILE* out, Server* V) {
+    applyUpdates(V);
+    answerBatch(out, V->G, V->pool, V->work, V->count, V->opt);
+    V->count = 0;
+}
+
+// Queues up one streamed update line, "+ u v" (or "+ u v w" for a weighted
+// Graph) adding an edge and "- u v" removing one. Updates are applied in
+// batches just before the next queries are answered, but the queries read
+// before an update are always answered on the Graph as it was.
+void updateLine(FILE* out, Server* V, char* text, int line) {
+
+    int u, v, w = 1;
+    char op, extra;
+    int args = sscanf(text, " %c %d %d %d %c", &op, &u, &v, &w, &extra);
+
+    // Make sure the line has the right number of arguments
+    if(args<3 || args>4 || (args==4 && (op=='-' || !V->opt->weighted))) {
+        fprintf(stderr, "Error in line %d of query stream\n", line);
+        return;
+    }
+
+    // Make sure the Graph can be changed, and that no saved search
+    // results are being reused, since they would go out of date
+    if(isCompressed(V->G)) {
+        fprintf(stderr, "Graph is compressed, ignoring update in line %d of query stream\n", line);
+        return;
+    }
+    if(V->opt->cache != NULL) {
+        fprintf(stderr, "Saved searches in use, ignoring update in line %d of query stream\n", line);
+        return;
+    }
+    if(V->opt->sketch != NULL) {
+        fprintf(stderr, "Landmarks in use, ignoring update in line %d of query stream\n", line);
+        return;
+    }
+
+    // Make sure both vertices are in the Graph, and the weight is allowed
+    if(u<1 || u>getOrder(V->G) || v<1 || v>getOrder(V->G)) {
+        fprintf(stderr, "Vertex out of range in line %d of query stream\n", line);
+        return;
+    }
+    if(w < 0) {
+        fprintf(stderr, "Weight out of range in line %d of query stream\n", line);
+        return;
+    }
+
+    // Answer the queries read so far before the Graph changes under them
+    if(V->count > 0) {
+        runQueued(out, V);
+    }
+
+    // Queue the change
+    List L = (op=='+') ? V->add : V->remove;
+    append(L, u);
+    append(L, v);
+    if(op == '+') {
+        append(V->weights, w);
+    }
+}
+
+// Queues up one streamed query line. Returns 0 if the line was the
+// terminating "0 0", otherwise 1. Bad lines are reported on stderr
+// and skipped so that one bad client can't take the server down.
+int streamLine(FILE* out, Server* V, char* text, int line) {
+
+    int sor, des;
+    char extra;
+
+    // Skip blank lines
+    if(strspn(text, " \t\r") == strlen(text)) {
+        return 1;
+    }
+
+    // Lines starting with + or - change the Graph
+    char* first = text + strspn(text, " \t");
+    if((*first=='+' || *first=='-') && (first[1]==' ' || first[1]=='\t')) {
+        updateLine(out, V, text, line);
+        return 1;
+    }
+
+    // Make sure there are exactly two arguments
+    if(sscanf(text, "%d %d %c", &sor, &des, &extra) != 2) {
+        fprintf(stderr, "Error in line %d of query stream\n", line);
+        return 1;
+    }
+
+    // The dummy line "0 0" ends the stream
+    if(sor==0 || des==0) {
+        return 0;
+    }
+
+    // Make sure both vertices are in the Graph
+    if(sor<1 || sor>getOrder(V->G) || des<1 || des>getOrder(V->G)) {
+        fprintf(stderr, "Vertex out of range in line %d of query stream\n", line);
+        return 1;
+    }
+
+    // Queue the query, answering the queue once a full batch is waiting
+    V->work[V->count].sor = sor;
+    V->work[V->count].des = des;
+    if(++V->count == V->opt->batch) {
+        runQueued(out, V);
+        fflush(out);
+    }
+    return 1;
+}
+
+// Reads "source destination" lines from the file descriptor fd until end of
+// input or "0 0", writing the answers to out. Queries are answered in batches
+// of opt->batch and the output is flushed after each one. A partial batch is
+// answered and flushed whenever no more input is waiting, so that a client
+// blocked on its answers is never left hanging.
+void serveQueries(int fd, FILE* out, Server* V) {
+
+    char buf[STREAM_BUFFER];
+    int len = 0;
+    int line = 0;
+    int open = 1;
+
+    while(open) {
+
+        // Queue up every complete line in the buffer
+        char* text = buf;
+        char* nl;
+        while(open && (nl = memchr(text, '\n', len - (text-buf))) != NULL) {
+            *nl = '\0';
+            open = streamLine(out, V, text, ++line);
+            text = nl + 1;
+        }
+        if(!open) {
+            break;
+        }
+
+        // Move the partial line left over to the front of the buffer
+        len -= text - buf;
+        memmove(buf, text, len);
+        if(len == STREAM_BUFFER-1) {
+            fprintf(stderr, "Line %d of query stream is too long\n", line+1);
+            len = 0;
+        }
+
+        // Answer what is queued before blocking if the client has nothing more to send
+        if(V->count > 0) {
+            struct pollfd p = { fd, POLLIN, 0 };
+            if(poll(&p, 1, 0) == 0) {
+                runQueued(out, V);
+                fflush(out);
+            }
+        }
+
+        // Read the next chunk of input
+        ssize_t got = read(fd, buf+len, STREAM_BUFFER-1-len);
+        if(got <= 0) {
+            // Queue a final line that has no newline
+            if(len > 0) {
+                buf[len] = '\0';
+                streamLine(out, V, buf, ++line);
+            }
+            break;
+        }
+        len += got;
+    }
+
+    runQueued(out, V);
+    fflush(out);
+}
+
+// Listens on the Unix socket at path and serves the queries of each
+// client that connects, one connection at a time, until killed.
+void serveSocket(char* path, Server* V) {
+
+    struct sockaddr_un addr;
+
+    // Make sure the path fits in a socket address
+    if(strlen(path) >= sizeof(addr.sun_path)) {
+        printf("Socket path %s is too long\n", path);
+        exit(1);
+    }
+
+    // Create the socket and bind it to path
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);
+    if(sock<0 || bind(sock, (struct sockaddr*)&addr, sizeof(addr))<0 || listen(sock, 16)<0) {
+        printf("Unable to listen on socket %s\n", path);
+        exit(1);
+    }
+
+    // A client hanging up early must not kill the server
+    signal(SIGPIPE, SIG_IGN);
+
+    while(1) {
+        int client = accept(sock, NULL, NULL);
+        if(client < 0) {
+            continue;
+        }
+        FILE* out = fdopen(client, "w");
+        if(out == NULL) {
+            close(client);
+            continue;
+        }
+        serveQueries(client, out, V);
+        fclose(out);
+    }
+}
+
+// A block of whole lines of the input file in the pipelined mode, with the
+// numbers on each line once it has been parsed
+typedef struct Chunk {
+    char* text;
+    long size;
+    long capacity;
+    // Up to three numbers for each line, and how many the line has, or -1
+    // if it holds anything else
+    int* value;
+    signed char* count;
+    int lines;
+    int room;
+    int state;
+} Chunk;
+
+// The reader and parser threads of the pipelined mode, and the ring of
+// Chunks they pass along. Chunk j of the file goes in slot j%PIPE_SLOTS,
+// which the reader only fills again once the Chunk before has been used.
+typedef struct Pipeline {
+    int fd;
+    Chunk slot[PIPE_SLOTS];
+    pthread_t reader;
+    pthread_t* parser;
+    int parsers;
+    pthread_mutex_t lock;
+    // Signalled whenever a Chunk changes state or the input ends
+    pthread_cond_t changed;
+    // Number of Chunks read, and handed to parsers, so far
+    long read;
+    long parsed;
+    int eof;
+    int quit;
+    // The start of a line left over at the end of the last Chunk read
+    char* carry;
+    long carrySize;
+} Pipeline;
+
+// Body of the reader thread: fills each free slot in turn with the next
+// PIPE_CHUNK bytes of the file, cut back to the end of its last whole line
+void* readerMain(void* arg) {
+
+    Pipeline* L = arg;
+
+    for(long j=0; ; j++) {
+        Chunk* C = &L->slot[j % PIPE_SLOTS];
+
+        // Wait for the slot to be free
+        pthread_mutex_lock(&L->lock);
+        while(C->state!=CHUNK_EMPTY && !L->quit) {
+            pthread_cond_wait(&L->changed, &L->lock);
+        }
+        int quit = L->quit;
+        pthread_mutex_unlock(&L->lock);
+        if(quit) {
+            break;
+        }
+
+        // Start with the line left over from the Chunk before, which grows
+        // the Chunk if a line is longer than one
+        if(C->capacity < L->carrySize + PIPE_CHUNK) {
+            C->capacity = L->carrySize + PIPE_CHUNK;
+            C->text = realloc(C->text, C->capacity);
+            if(C->text == NULL) {
+                printf("Unable to allocate %ld bytes of input\n", C->capacity);
+                exit(1);
+            }
+        }
+        if(L->carrySize > 0) {
+            memcpy(C->text, L->carry, L->carrySize);
+        }
+        long size = L->carrySize;
+        int end = 0;
+        while(size < C->capacity) {
+            ssize_t got = read(L->fd, C->text + size, C->capacity - size);
+            if(got <= 0) {
+                end = 1;
+                break;
+            }
+            size += got;
+        }
+
+        // Keep back the last line unless the file has ended
+        long cut = size;
+        while(!end && cut>0 && C->text[cut-1]!='\n') {
+            cut--;
+        }
+        L->carrySize = size - cut;
+        L->carry = realloc(L->carry, L->carrySize + 1);
+        memcpy(L->carry, C->text + cut, L->carrySize);
+        C->size = cut;
+
+        pthread_mutex_lock(&L->lock);
+        C->state = CHUNK_READ;
+        L->read++;
+        L->eof = end;
+        pthread_cond_broadcast(&L->changed);
+        pthread_mutex_unlock(&L->lock);
+        if(end) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+// Parses every line of the Chunk C into numbers
+void parseChunk(Chunk* C) {
+
+    char* p = C->text;
+    char* end = C->text + C->size;
+
+    // Count the lines so there is room for the numbers of every one
+    int lines = 0;
+    for(char* q=p; (q = memchr(q, '\n', end-q)) != NULL; q++) {
+        lines++;
+    }
+    if(C->size>0 && end[-1]!='\n') {
+        lines++;
+    }
+    if(lines > C->room) {
+        C->room = lines;
+        C->value = realloc(C->value, 3 * (long)lines * sizeof(int));
+        C->count = realloc(C->count, lines);
+        if(C->value==NULL || C->count==NULL) {
+            printf("Unable to allocate room for %d lines of input\n", lines);
+            exit(1);
+        }
+    }
+
+    for(int i=0; i<lines; i++) {
+        int k = 0;
+        while(p<end && *p!='\n') {
+            if(*p==' ' || *p=='\t' || *p=='\r') {
+                p++;
+                continue;
+            }
+
+            // Read one number, giving up on the line if it holds
+            // anything else or more than three of them
+            int negative = (*p == '-');
+            if(*p=='-' || *p=='+') {
+                p++;
+            }
+            char* digits = p;
+            long x = 0;
+            while(p<end && *p>='0' && *p<='9' && x<=INT_MAX) {
+                x = 10*x + (*p++ - '0');
+            }
+            if(p==digits || x>INT_MAX || k==3
+               || (p<end && *p!=' ' && *p!='\t' && *p!='\r' && *p!='\n')) {
+                k = -1;
+                while(p<end && *p!='\n') {
+                    p++;
+                }
+                break;
+            }
+            C->value[3*i + k++] = negative ? -x : x;
+        }
+        C->count[i] = k;
+        p++;
+    }
+    C->lines = lines;
+}
+
+// Body of each parser thread: parses Chunks as they are read, in the order
+// they were read, until the input ends
+void* parserMain(void* arg) {
+
+    Pipeline* L = arg;
+
+    pthread_mutex_lock(&L->lock);
+    while(1) {
+        while(L->parsed==L->read && !L->eof && !L->quit) {
+            pthread_cond_wait(&L->changed, &L->lock);
+        }
+        if(L->quit || L->parsed==L->read) {
+            break;
+        }
+        Chunk* C = &L->slot[L->parsed++ % PIPE_SLOTS];
+        pthread_mutex_unlock(&L->lock);
+        parseChunk(C);
+        pthread_mutex_lock(&L->lock);
+        C->state = CHUNK_PARSED;
+        pthread_cond_broadcast(&L->changed);
+    }
+    pthread_mutex_unlock(&L->lock);
+    return NULL;
+}
+
+// Returns a new Pipeline reading the file fd on one thread and parsing
+// it on the given number of others
+Pipeline* newPipeline(int fd, int parsers) {
+
+    Pipeline* L = calloc(1, sizeof(Pipeline));
+    L->fd = fd;
+    L->parsers = parsers;
+    L->parser = malloc(parsers * sizeof(pthread_t));
+    pthread_mutex_init(&L->lock, NULL);
+    pthread_cond_init(&L->changed, NULL);
+
+    // The file is read from front to back exactly once
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    if(pthread_create(&L->reader, NULL, readerMain, L) != 0) {
+        printf("Unable to start reader thread\n");
+        exit(1);
+    }
+    for(int t=0; t<parsers; t++) {
+        if(pthread_create(&L->parser[t], NULL, parserMain, L) != 0) {
+            printf("Unable to start parser thread %d\n", t);
+            exit(1);
+        }
+    }
+    return L;
+}
+
+// Stops the threads of *pL, whether or not the input has been read to the
+// end, and frees the Pipeline
+void freePipeline(Pipeline** pL) {
+
+    if(pL!=NULL && *pL!=NULL) {
+        Pipeline* L = *pL;
+        pthread_mutex_lock(&L->lock);
+        L->quit = 1;
+        pthread_cond_broadcast(&L->changed);
+        pthread_mutex_unlock(&L->lock);
+        pthread_join(L->reader, NULL);
+        for(int t=0; t<L->parsers; t++) {
+            pthread_join(L->parser[t], NULL);
+        }
+        for(int i=0; i<PIPE_SLOTS; i++) {
+            free(L->slot[i].text);
+            free(L->slot[i].value);
+            free(L->slot[i].count);
+        }
+        pthread_mutex_destroy(&L->lock);
+        pthread_cond_destroy(&L->changed);
+        free(L->parser);
+        free(L->carry);
+        free(L);
+        *pL = NULL;
+    }
+}
+
+// Returns Chunk j of the file once it has been parsed, or NULL if the file
+// ended before it. Chunks have to be taken in order, and each handed back
+// with doneChunk() before the next is taken.
+Chunk* nextChunk(Pipeline* L, long j) {
+
+    Chunk* C = &L->slot[j % PIPE_SLOTS];
+
+    pthread_mutex_lock(&L->lock);
+    while(!(j<L->read && C->state==CHUNK_PARSED) && !(L->eof && j>=L->read)) {
+        pthread_cond_wait(&L->changed, &L->lock);
+    }
+    if(j >= L->read) {
+        C = NULL;
+    }
+    pthread_mutex_unlock(&L->lock);
+    return C;
+}
+
+// Hands the Chunk C back to the reader once its lines have been used
+void doneChunk(Pipeline* L, Chunk* C) {
+    pthread_mutex_lock(&L->lock);
+    C->state = CHUNK_EMPTY;
+    pthread_cond_broadcast(&L->changed);
+    pthread_mutex_unlock(&L->lock);
+}
+
+// The thread of the pipelined mode that writes out the graph, and then each
+// block of answers handed to it while the next block is being answered
+typedef struct Printer {
+    FILE* out;
+    Graph graph;
+    Options* opt;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    // Signalled when a block is handed over and when it has been written
+    pthread_cond_t changed;
+    // The block of answers to write next, or NULL
+    Answer* work;
+    int count;
+    int quit;
+} Printer;
+
+// Body of the printer thread
+void* printerMain(void* arg) {
+
+    Printer* W = arg;
+
+    dumpGraph(W->out, W->graph, W->opt);
+
+    pthread_mutex_lock(&W->lock);
+    while(1) {
+        while(W->work==NULL && !W->quit) {
+            pthread_cond_wait(&W->changed, &W->lock);
+        }
+        if(W->work == NULL) {
+            break;
+        }
+        pthread_mutex_unlock(&W->lock);
+        for(int q=0; q<W->count; q++) {
+            printAnswer(W->out, &W->work[q], W->opt);
+        }
+        pthread_mutex_lock(&W->lock);
+        W->work = NULL;
+        pthread_cond_broadcast(&W->changed);
+    }
+    pthread_mutex_unlock(&W->lock);
+    return NULL;
+}
+
+// Starts the Printer W writing the graph G to out
+void startPrinter(Printer* W, FILE* out, Graph G, Options* opt) {
+    W->out = out;
+    W->graph = G;
+    W->opt = opt;
+    W->work = NULL;
+    W->count = 0;
+    W->quit = 0;
+    pthread_mutex_init(&W->lock, NULL);
+    pthread_cond_init(&W->changed, NULL);
+    if(pthread_create(&W->thread, NULL, printerMain, W) != 0) {
+        printf("Unable to start printer thread\n");
+        exit(1);
+    }
+}
+
+// Hands the count answers in work to the Printer W once it has written
+// the block before, which is then free to be used again
+void printBlock(Printer* W, Answer* work, int count) {
+    pthread_mutex_lock(&W->lock);
+    while(W->work != NULL) {
+        pthread_cond_wait(&W->changed, &W->lock);
+    }
+    W->work = work;
+    W->count = count;
+    pthread_cond_broadcast(&W->changed);
+    pthread_mutex_unlock(&W->lock);
+}
+
+// Waits for the Printer W to write everything handed to it, and stops it
+void stopPrinter(Printer* W) {
+    pthread_mutex_lock(&W->lock);
+    while(W->work != NULL) {
+        pthread_cond_wait(&W->changed, &W->lock);
+    }
+    W->quit = 1;
+    pthread_cond_broadcast(&W->changed);
+    pthread_mutex_unlock(&W->lock);
+    pthread_join(W->thread, NULL);
+    pthread_mutex_destroy(&W->lock);
+    pthread_cond_destroy(&W->changed);
+}
+
+// Answers the queries in the input file in, named name, and writes
+// everything to out, with the file read, parsed, loaded and answered all at
+// once. A reader thread reads the file in large blocks, opt->threads parser
+// threads turn them into numbers, this thread gathers the edges and loads
+// them in one go with addEdges(), and then answers the queries a block at a
+// time while a printer thread writes out the graph and the block before.
+// Every edge and query has to be on a line of its own.
+void answerPipelined(FILE* in, FILE* out, char* name, Options* opt) {
+
+    Pipeline* L = newPipeline(fileno(in), opt->threads);
+    Graph G = NULL;
+    Pool* P = NULL;
+    Printer W;
+
+    // Edges read so far, and their weights in weighted mode
+    int* edge = NULL;
+    int* weight = NULL;
+    long edges = 0;
+    long room = 0;
+
+    // Two blocks of queries, one being answered while the other is written
+    Answer* block[2] = { newAnswers(QUERY_BLOCK), newAnswers(QUERY_BLOCK) };
+    int which = 0;
+    int count = 0;
+
+    // Go through the lines: first the order, then the edges up to "0 0",
+    // then the queries up to "0 0"
+    int stage = 0;
+    int line = 0;
+    for(long j=0; stage<3; j++) {
+        Chunk* C = nextChunk(L, j);
+        if(C == NULL) {
+            printf("Error in line %d of input %s\n", line+1, name);
+            exit(1);
+        }
+
+        for(int i=0; i<C->lines && stage<3; i++) {
+            int k = C->count[i];
+            int* x = &C->value[3*i];
+            line++;
+            if(k == 0) {
+                continue;
+            }
+
+            if(stage == 0) {
+                // Get the order and make sure there is only one argument
+                if(k != 1) {
+                    printf("Error in first line of input %s\n", name);
+                    exit(1);
+                }
+                G = newGraphPolicy(x[0], opt->policy);
+                setDedup(G, opt->dedup);
+                if(opt->budget > 0) {
+                    setMemoryBudget(G, opt->budget);
+                }
+                stage = 1;
+
+            } else if(stage==1 && k==2 && (x[0]==0 || x[1]==0)) {
+                // Load every edge, then start writing the graph out while
+                // the queries are being read
+                addEdges(G, edge, opt->weighted ? weight : NULL, edges);
+                free(edge);
+                free(weight);
+                if(opt->dedup) {
+                    fprintf(stderr, "Dropped %d duplicate edges and self-loops from %s\n", getDropped(G), name);
+                }
+                if(opt->compress) {
+                    compressGraph(G);
+                }
+                fitBudget(G, opt);
+                if(opt->landmarks > 0) {
+                    opt->sketch = newSketch(G, opt->landmarks, opt->threads);
+                }
+                startPrinter(&W, out, G, opt);
+                P = opt->threads>1 ? newPool(G, opt) : NULL;
+                stage = (opt->output & OUTPUT_QUERIES) ? 2 : 3;
+
+            } else if(stage == 1) {
+                // Make sure the edge has two vertices and, in weighted
+                // mode, a non-negative weight
+                if(k!=(opt->weighted ? 3 : 2) || (opt->weighted && x[2]<0)) {
+                    printf("Error in line %d of input %s\n", line, name);
+                    exit(1);
+                }
+                if(edges == room) {
+                    room = 2*room + 1024;
+                    edge = realloc(edge, 2 * room * sizeof(int));
+                    weight = opt->weighted ? realloc(weight, room * sizeof(int)) : NULL;
+                    if(edge==NULL || (opt->weighted && weight==NULL)) {
+                        printf("Unable to allocate room for %ld edges\n", room);
+                        exit(1);
+                    }
+                }
+                edge[2*edges] = x[0];
+                edge[2*edges+1] = x[1];
+                if(opt->weighted) {
+                    weight[edges] = x[2];
+                }
+                edges++;
+
+            } else {
+                // Queue the query, answering the block once it is full
+                // and handing it over to be written
+                if(k != 2) {
+                    printf("Error in line %d of input %s\n", line, name);
+                    exit(1);
+                }
+                if(x[0]==0 || x[1]==0) {
+                    stage = 3;
+                    break;
+                }
+                block[which][count].sor = x[0];
+                block[which][count].des = x[1];
+                if(++count == QUERY_BLOCK) {
+                    solveBatch(G, P, block[which], count, opt);
+                    printBlock(&W, block[which], count);
+                    which ^= 1;
+                    count = 0;
+                }
+            }
+        }
+        doneChunk(L, C);
+    }
+    freePipeline(&L);
+
+    // Answer the queries left over and wait for everything to be written
+    solveBatch(G, P, block[which], count, opt);
+    printBlock(&W, block[which], count);
+    stopPrinter(&W);
+
+    // Follow the answers with the centrality and diameter if asked to
+    if(opt->samples >= 0) {
+        printCentrality(out, G, opt);
+    }
+    if(opt->diameter) {
+        printDiameter(out, G);
+    }
+    if(opt->policy != ALLOC_DEFAULT) {
+        printPlacement(stderr, G);
+    }
+    if(opt->report) {
+        printMemory(stderr, G, opt);
+    }
+
+    freeAnswers(&block[0], QUERY_BLOCK);
+    freeAnswers(&block[1], QUERY_BLOCK);
+    freePool(&P);
+    freeSketch(&opt->sketch);
+    freeGraph(&G);
+}
+
+int main(int argc, char * argv[]) {
+
+    FILE *in, *out;
+    int i, sor, des;
+    int a;
+    Options opt = { -1, 0, NULL, 64, 1, 0, ALLOC_DEFAULT, 0, NULL, 0, -1, 0, 0, 0, NULL, -1, 0, 0, 0, NULL, 0,
+                     OUTPUT_GRAPH | OUTPUT_QUERIES, NULL, DUMP_TEXT, NULL, 0, 0 };
+
+    // Read the options that come before the file names
+    for(a=1; a<argc && argv[a][0]=='-'; a++) {
+        if(strcmp(argv[a], "-k")==0 && a+1<argc) {
+            opt.depth = atoi(argv[++a]);
+            if(opt.depth < 0) {
+                printf("Depth must be non-negative: %s\n", argv[a]);
+                exit(1);
+            }
+        } else if(strcmp(argv[a], "-s")==0) {
+            opt.stream = 1;
+        } else if(strcmp(argv[a], "-u")==0 && a+1<argc) {
+            opt.socket = argv[++a];
+        } else if(strcmp(argv[a], "-b")==0 && a+1<argc) {
+            opt.batch = atoi(argv[++a]);
+            if(opt.batch < 1) {
+                printf("Batch size must be positive: %s\n", argv[a]);
+                exit(1);
+            }
+        } else if(strcmp(argv[a], "-t")==0 && a+1<argc) {
+            opt.threads = atoi(argv[++a]);
+            if(opt.threads < 1) {
+                printf("Number of threads must be positive: %s\n", argv[a]);
+                exit(1);
+            }
+        } else if(strcmp(argv[a], "-z")==0) {
+            opt.compress = 1;
+        } else if(strcmp(argv[a], "-w")==0) {
+            opt.weighted = 1;
+        } else if(strcmp(argv[a], "-C")==0 && a+1<argc) {
+            opt.samples = atoi(argv[++a]);
+            if(opt.samples < 0) {
+                printf("Number of samples must be non-negative: %s\n", argv[a]);
+                exit(1);
+            }
+        } else if(strcmp(argv[a], "-P")==0 && a+1<argc) {
+            opt.procs = atoi(argv[++a]);
+            if(opt.procs < 1) {
+                printf("Number of processes must be positive: %s\n", argv[a]);
+                exit(1);
+            }
+        } else if(strcmp(argv[a], "-x")==0 && a+1<argc) {
+            opt.external = argv[++a];
+        } else if(strcmp(argv[a], "-g")==0 && a+1<argc) {
+            opt.resident = atol(argv[++a]);
+            if(opt.resident < 0) {
+                printf("Cache size must be non-negative: %s\n", argv[a]);
+                exit(1);
+            }
+        } else if(strcmp(argv[a], "-n")==0) {
+            opt.count = 1;
+        } else if(strcmp(argv[a], "-e")==0) {
+            opt.count = 1;
+            opt.enumerate = 1;
+        } else if(strcmp(argv[a], "-L")==0 && a+1<argc) {
+            opt.landmarks = atoi(argv[++a]);
+            if(opt.landmarks < 1) {
+                printf("Number of landmarks must be positive: %s\n", argv[a]);
+                exit(1);
+            }
+        } else if(strcmp(argv[a], "-m")==0 && a+1<argc) {
+            a++;
+            if(strcmp(argv[a], "queries")==0) {
+                opt.output = OUTPUT_QUERIES;
+            } else if(strcmp(argv[a], "graph")==0) {
+                opt.output = OUTPUT_GRAPH;
+            } else if(strcmp(argv[a], "both")==0) {
+                opt.output = OUTPUT_GRAPH | OUTPUT_QUERIES;
+            } else {
+                printf("Output must be queries, graph or both: %s\n", argv[a]);
+                exit(1);
+            }
+        } else if(strcmp(argv[a], "-a")==0 && a+1<argc) {
+            opt.dump = argv[++a];
+        } else if(strcmp(argv[a], "-f")==0 && a+1<argc) {
+            a++;
+            if(strcmp(argv[a], "text")==0) {
+                opt.format = DUMP_TEXT;
+            } else if(strcmp(argv[a], "binary")==0) {
+                opt.format = DUMP_BINARY;
+            } else if(strcmp(argv[a], "gzip")==0) {
+                opt.format = DUMP_GZIP;
+            } else {
+                printf("Format must be text, binary or gzip: %s\n", argv[a]);
+                exit(1);
+            }
+        } else if(strcmp(argv[a], "-p")==0) {
+            opt.pipelined = 1;
+        } else if(strcmp(argv[a], "-D")==0) {
+            opt.diameter = 1;
+        } else if(strcmp(argv[a], "-B")==0) {
+            opt.between = 1;
+        } else if(strcmp(argv[a], "-d")==0) {
+            opt.dedup = 1;
+        } else if(strcmp(argv[a], "-c")==0 && a+1<argc) {
+            opt.cache = argv[++a];
+        } else if(strcmp(argv[a], "-M")==0 && a+1<argc) {
+            opt.budget = parseBytes(argv[++a]);
+            if(opt.budget < 1) {
+                printf("Memory budget must be a positive number of bytes: %s\n", argv[a]);
+                exit(1);
+            }
+        } else if(strcmp(argv[a], "-R")==0) {
+            opt.report = 1;
+        } else if(strcmp(argv[a], "-H")==0) {
+            opt.policy |= ALLOC_HUGEPAGES;
+        } else if(strcmp(argv[a], "-N")==0) {
+            opt.policy |= ALLOC_INTERLEAVE;
+        } else {
+            printf("Unknown option %s\n", argv[a]);
+            exit(1);
+        }
+    }
+
+    // Depth limits only apply to BFS
+    if(opt.weighted && opt.depth>=0) {
+        printf("Options -w and -k can't be used together\n");
+        exit(1);
+    }
+
+    // Paths are only counted by unrestricted BFS, and listed
+    // while the one Search that found them is at hand
+    if(opt.count && (opt.weighted || opt.depth>=0)) {
+        printf("Options -n and -e can't be used with -w or -k\n");
+        exit(1);
+    }
+    if(opt.enumerate && opt.threads>1) {
+        printf("Options -e and -t can't be used together\n");
+        exit(1);
+    }
+
+    // Worker processes only answer plain queries from an input file
+    if(opt.procs>0 && (opt.depth>=0 || opt.weighted || opt.count || opt.compress || opt.dedup
+                       || opt.cache!=NULL || opt.samples>=0 || opt.threads>1 || opt.stream || opt.socket!=NULL
+                       || opt.between || opt.diameter || opt.landmarks>0 || opt.pipelined || opt.dump!=NULL
+                       || opt.budget>0 || opt.report)) {
+        printf("Option -P can only be used with -m, -H and -N\n");
+        exit(1);
+    }
+
+    // Searches from both ends only find one shortest path
+    if(opt.between && (opt.depth>=0 || opt.weighted || opt.count || opt.cache!=NULL)) {
+        printf("Option -B can't be used with -k, -w, -n, -e or -c\n");
+        exit(1);
+    }
+
+    // Landmark distances count edges, and only give one shortest path
+    if(opt.landmarks>0 && (opt.depth>=0 || opt.weighted || opt.count || opt.cache!=NULL)) {
+        printf("Option -L can't be used with -k, -w, -n, -e or -c\n");
+        exit(1);
+    }
+
+    // The adjacency lists only go to a file of their own if they are
+    // written at all, and only there in a format other than text. The
+    // binary format has no room for weights.
+    if(opt.format!=DUMP_TEXT && opt.dump==NULL) {
+        printf("Option -f needs -a\n");
+        exit(1);
+    }
+    if(opt.dump!=NULL && !(opt.output & OUTPUT_GRAPH)) {
+        printf("Option -a can't be used with -m queries\n");
+        exit(1);
+    }
+    if(opt.format==DUMP_BINARY && opt.weighted) {
+        printf("Option -f binary can't be used with -w\n");
+        exit(1);
+    }
+
+    // Nothing but answers are written in the streaming modes
+    if((opt.stream || opt.socket!=NULL) && (opt.output!=(OUTPUT_GRAPH | OUTPUT_QUERIES) || opt.dump!=NULL)) {
+        printf("Options -m and -a can't be used with -s or -u\n");
+        exit(1);
+    }
+
+    // and nothing follows them, since the stream of queries has no end
+    if((opt.stream || opt.socket!=NULL) && (opt.samples>=0 || opt.diameter)) {
+        printf("Options -C and -D can't be used with -s or -u\n");
+        exit(1);
+    }
+
+    // The pipelined mode only answers queries from an input file, and
+    // prints answers away from the Search that found them
+    if(opt.pipelined && (opt.enumerate || opt.stream || opt.socket!=NULL)) {
+        printf("Option -p can't be used with -e, -s or -u\n");
+        exit(1);
+    }
+
+    // Lists are only read lazily from the graph on disk
+    if(opt.resident>=0 && opt.external==NULL) {
+        printf("Option -g can only be used with -x\n");
+        exit(1);
+    }
+
+    // The graph on disk only answers plain queries from an input file
+    if(opt.external!=NULL && (opt.depth>=0 || opt.weighted || opt.count || opt.compress || opt.dedup
+                              || opt.cache!=NULL || opt.samples>=0 || opt.threads>1 || opt.procs>0
+                              || opt.policy!=ALLOC_DEFAULT || opt.stream || opt.socket!=NULL || opt.between
+                              || opt.diameter || opt.landmarks>0 || opt.pipelined || opt.dump!=NULL
+                              || opt.budget>0 || opt.report)) {
+        printf("Option -x can only be used with -g and -m\n");
+        exit(1);
+    }
+
+    // Streaming modes only take the graph file, since queries arrive
+    // on stdin or the socket and answers leave the same way
+    if(opt.stream || opt.socket!=NULL) {
+        if( argc-a != 1 ){
+            printf("Usage: %s [-k depth] [-t threads] [-z] [-w] [-n] [-e] [-B] [-L landmarks] [-d] [-c dir] [-M budget] [-R] [-H] [-N] [-b batch] -s|-u <socket> <graph file>\n", argv[0]);
+            exit(1);
+        }
+        in = fopen(argv[a], "r");
+        if( in==NULL ){
+            printf("Unable to open file %s for reading\n", argv[a]);
+            exit(1);
+        }
+
+        // Load the graph once and keep it resident for every query
+        Server V;
+        V.G = readGraph(in, argv[a], &i, &opt);
+        fclose(in);
+        if(opt.compress) {
+            compressGraph(V.G);
+        }
+        if(opt.landmarks > 0) {
+            opt.sketch = newSketch(V.G, opt.landmarks, opt.threads);
+        }
+        V.pool = opt.threads>1 ? newPool(V.G, &opt) : NULL;
+        V.opt = &opt;
+        V.work = newAnswers(opt.batch);
+        V.count = 0;
+        V.add = newList();
+        V.weights = newList();
+        V.remove = newList();
+
+        if(opt.socket != NULL) {
+            serveSocket(opt.socket, &V);
+        } else {
+            // Write answers in large blocks rather than line by line
+            setvbuf(stdout, NULL, _IOFBF, STREAM_BUFFER);
+            serveQueries(STDIN_FILENO, stdout, &V);
+        }
+
+        if(opt.report) {
+            printMemory(stderr, V.G, &opt);
+        }
+        freeAnswers(&V.work, opt.batch);
+        freeList(&V.add);
+        freeList(&V.weights);
+        freeList(&V.remove);
+        freePool(&V.pool);
+        freeSketch(&opt.sketch);
+        freeGraph(&V.G);
+        return(0);
+    }
+
+    // Check command line for correct number of arguments
+    if( argc-a != 2 ){
+        printf("Usage: %s [-k depth] [-t threads] [-z] [-w] [-n] [-e] [-B] [-L landmarks] [-d] [-c dir] [-C samples] [-D] [-p] [-m queries|graph|both] [-a dumpfile [-f text|binary|gzip]] [-P procs] [-x edgefile [-g cache]] [-M budget] [-R] [-H] [-N] <input file> <output file>\n", argv[0]);
+        exit(1);
+    }
+
+    // Open files for reading and writing
+    in = fopen(argv[a], "r");
+    out = fopen(argv[a+1], "w");
+    if( in==NULL ){
+        printf("Unable to open file %s for reading\n", argv[a]);
+        exit(1);
+    }
+    if( out==NULL ){
+        printf("Unable to open file %s for writing\n", argv[a+1]);
+        exit(1);
+    }
+    opt.input = argv[a];
+
+    // Split the graph over worker processes if asked to
+    if(opt.procs > 0) {
+        answerDistributed(in, out, argv[a], &opt);
+        fclose(in);
+        fclose(out);
+        return(0);
+    }
+
+    // Keep the graph on disk if asked to
+    if(opt.external != NULL) {
+        answerExternal(in, out, argv[a], &opt);
+        fclose(in);
+        fclose(out);
+        return(0);
+    }
+
+    // Read, load and answer all at once if asked to
+    if(opt.pipelined) {
+        answerPipelined(in, out, argv[a], &opt);
+        fclose(in);
+        fclose(out);
+        return(0);
+    }
+
+    Graph G = readGraph(in, argv[a], &i, &opt);
+    if(opt.compress) {
+        compressGraph(G);
+    }
+    fitBudget(G, &opt);
+    if(opt.landmarks > 0) {
+        opt.sketch = newSketch(G, opt.landmarks, opt.threads);
+    }
+
+    dumpGraph(out, G, &opt);
+
+    // Read the queries unless only the graph is wanted
+    sor = des = 0;
+    if(opt.output & OUTPUT_QUERIES) {
+
+        // Incremenet line counter
+        i++;
+
+        // Get first path and make sure there are two arguments
+        if(fscanf(in, "%d %d", &sor, &des) != 2) {
+            printf("Error in line %d of input %s\n", i, argv[a]);
+            exit(1);
+        }
+    }
+
+    // Start the workers, if there are to be any, and
+    // create the block of queries answered at a time
+    Pool* P = opt.threads>1 ? newPool(G, &opt) : NULL;
+    Answer* work = newAnswers(QUERY_BLOCK);
+    int count = 0;
+
+    // Run loop while the paths inputted don't point to 0
+    while(sor!=0 && des!=0) {
+        // Queue the query, answering the queue once the block is full
+        work[count].sor = sor;
+        work[count].des = des;
+        if(++count == QUERY_BLOCK) {
+            answerBatch(out, G, P, work, count, &opt);
+            count = 0;
+        }
 
         // Increment the line counter
         i++;
 
         // Get the next path and make sure there are two arguments
         if(fscanf(in, " %d %d", &sor, &des) != 2) {
-            printf("Error in line %d of input %s\n", i, argv[1]);
+            printf("Error in line %d of input %s\n", i, argv[a]);
             exit(1);
         }
     }
 
-    // Free the List and Graph
-    freeList(&L);
+    // Answer the queries left over
+    answerBatch(out, G, P, work, count, &opt);
+
+    // Follow the answers with the centrality of every vertex if asked to
+    if(opt.samples >= 0) {
+        printCentrality(out, G, &opt);
+    }
+
+    // and with the diameter and radius
+    if(opt.diameter) {
+        printDiameter(out, G);
+    }
+
+    // Report where the graph ended up if it was given a policy, and how
+    // much memory it took if asked to
+    if(opt.policy != ALLOC_DEFAULT) {
+        printPlacement(stderr, G);
+    }
+    if(opt.report) {
+        printMemory(stderr, G, &opt);
+    }
+
+    // Free the queries, workers and Graph
+    freeAnswers(&work, QUERY_BLOCK);
+    freePool(&P);
+    freeSketch(&opt.sketch);
     freeGraph(&G);
 
     // Close the files and return
@@ -119,4 +1951,3 @@ int main(int argc, char * argv[]) {
     return(0);
 
 }
-
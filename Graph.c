@@ -1,6 +1,11 @@
+#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
 #include <stdlib.h>
-#include <assert.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
 #include "Graph.h"
 
 // structs --------------------------------------------------------------------
@@ -9,55 +14,420 @@ typedef struct GraphObj {
 
     // Array of Lists whose ith element contains the neighbors of vertex i
     List* neighbor;
-    // Array of ints whose ith element is the color (white,grey,black) of vertex i
-    int* color;
-    // Array of ints whose ith element is the parent of vertex i
-    int* parent;
-    // Array of ints whose ith element is the distance from 
-    // the (most recent) source to vertex i
-    int* distance;
+    // Array of Lists whose ith element holds the weights of the edges to the
+    // neighbors of vertex i, position by position, or NULL if no weighted
+    // edge has been added
+    List* weight;
+    // True (1) if a weighted edge has been added
+    int weighted;
+    // The largest edge weight added so far
+    int maxWeight;
     // The number of vertices of the graph
     int order;
     // The number of edges of the graph
     int size;
+    // True (1) if duplicate edges and self-loops are dropped as they are
+    // added, and the number of edges dropped so far
+    int dedup;
+    int dropped;
+    // CSR index of the adjacency Lists: the neighbors of vertex i are
+    // target[offset[i]] through target[offset[i]+degree[i]-1], in sorted
+    // order. After edges have been removed or added to an indexed graph
+    // each slice may have room to spare, up to target[offset[i+1]-1].
+    long* offset;
+    int* degree;
+    int* target;
+    // Weights of the edges to the neighbors in target, if the graph is weighted
+    int* cost;
+    // True (1) if the CSR index matches the adjacency Lists
+    int indexed;
+    // True (1) once an arc has been added or removed on its own, after
+    // which the adjacency Lists may no longer be symmetric
+    int directed;
+    // CSR index of the transpose of a directed graph, built when first
+    // wanted: the in-neighbors of vertex i, the vertices with an arc to i,
+    // are reverseTarget[reverseOffset[i]] through
+    // reverseTarget[reverseOffset[i+1]-1], in sorted order. reversed is
+    // true (1) if it matches the adjacency Lists.
+    long* reverseOffset;
+    int* reverseTarget;
+    int reversed;
+    // Vertices whose adjacency List has changed since the CSR index was
+    // built, so only their slices need copying again. dirtyFlag[i] is true
+    // (1) if i is in the dirty array, and dirtyCount is -1 once so many
+    // vertices have changed that the whole index should be rebuilt.
+    int* dirty;
+    unsigned char* dirtyFlag;
+    int dirtyCount;
+    // Compressed adjacency, used in place of the Lists and the CSR index
+    // once compressGraph() has been called: the neighbors of vertex i are
+    // packed[packOffset[i]] through packed[packOffset[i+1]-1], stored as
+    // the gaps between consecutive sorted neighbors in varint form, each
+    // followed by the weight of the edge if the graph is weighted
+    unsigned char* packed;
+    long* packOffset;
+    // The largest number of neighbors of any vertex of a compressed graph
+    int maxDegree;
+    // Guards the lazy (re)building of the CSR index, and of the checksum
+    pthread_mutex_t lock;
+    // FNV-1a checksum of the degree, neighbors and edge weights of every
+    // vertex in turn, which ties files written by saveSearch() to the
+    // edges they were searched over. summed is true (1) if it matches the
+    // adjacency Lists.
+    unsigned long long checksum;
+    int summed;
+    // Search holding the result of the most recent call to BFS()
+    Search state;
+    // Allocation policy (see Memory.h) of the arrays of the graph
+    int policy;
+    // Bytes held by the graph and its Searches, by kind (see getMemory()),
+    // not counting the adjacency Lists, which charge their own bytes to
+    // listBytes as they grow and shrink. committed is all of memory[]
+    // together, which every allocation reserves its bytes from before it
+    // is made. peak is the most held at any one time, and budget the most
+    // they may hold, or 0 for no limit.
+    long memory[MEMORY_KINDS];
+    long committed;
+    long listBytes;
+    long peak;
+    long budget;
+
+} GraphObj;
+
+// Private SearchObj type
+// Holds everything one BFS writes, so that several Searches can run
+// over the same Graph at once, e.g. one per thread.
+typedef struct SearchObj {
+
+    // The Graph this Search runs over
+    Graph graph;
+    // Array of ints whose ith element is the parent of vertex i
+    int* parent;
+    // Array of ints whose ith element is the distance from the source to
+    // vertex i, or INF while vertex i is undiscovered
+    int* distance;
+    // Frontier buffer holding the vertices discovered by the most
+    // recent BFS in the order they were discovered
+    int* queue;
+    // Array of ints whose dth element is the index in queue at which
+    // level d of the most recent BFS begins
+    int* levelStart;
+    // The number of levels reached by the most recent BFS
+    int levels;
     // Vertex that was most recently used as source for BFS
     int source;
+    // Buffers the neighbors of one vertex (and the weights of the edges to
+    // them) are decoded into when the Graph is compressed
+    int* scratch;
+    int* scratchCost;
+    int scratchSize;
+    // File mapped by loadSearch(), or NULL. While one is loaded, parent,
+    // distance, queue and levelStart point into it, and the Search's own
+    // arrays are kept aside until it runs again.
+    const void* snapshot;
+    size_t snapshotBytes;
+    int* kept[4];
+    // True (1) if the most recent run was searchCount(), which also fills
+    // in the arrays below; they are allocated the first time it runs.
+    // paths[v] is the number of shortest paths from the source to v. The
+    // shortest-path DAG lists the predecessors of v, i.e. the neighbors one
+    // step closer to the source, in pred[predStart[v]..predStart[v+1]-1].
+    int counted;
+    unsigned long long* paths;
+    long* predStart;
+    int* pred;
+    long predSize;
+    // Arrays of searchBetween(), allocated the first time it runs: the
+    // distances, parents and queue of the search forward from the source
+    // (side 0) and backward from the destination (side 1). Every distance
+    // is INF and every parent NIL between runs.
+    int* sideDistance[2];
+    int* sideParent[2];
+    int* sideQueue[2];
+
+} SearchObj;
+
+// Private PathIteratorObj type
+// Walks the shortest-path DAG of a Search back from the target, taking
+// the choice[i]th predecessor of at[i] as at[i+1], so that each path is
+// one setting of the choices and the next path is found by advancing the
+// choice nearest the source that can still be advanced.
+typedef struct PathIteratorObj {
+    Search search;
+    int target;
+    // Number of edges on every path, or -1 if there are none
+    int length;
+    // True (1) until the first path has been returned
+    int first;
+    // at[0] is the target and at[length] the source
+    int* at;
+    int* choice;
+} PathIteratorObj;
+
+// Private SnapshotHeader type
+// Start of a file written by saveSearch(). It is followed by the arrays
+// parent[0..n], distance[0..n], levelStart[0..levels] and
+// queue[0..reached-1] of the Search, as native ints.
+typedef struct SnapshotHeader {
+    char magic[8];
+    // Order and size of the Graph the Search ran over
+    int order;
+    int size;
+    int source;
+    int levels;
+    // Number of vertices in the queue, i.e. discovered by BFS
+    int reached;
+    int unused;
+    // Checksum of the adjacency of the Graph (see GraphObj)
+    unsigned long long checksum;
+} SnapshotHeader;
+
+// Identifies snapshot files, and the version of their layout
+#define SNAPSHOT_MAGIC "BFSSNAP2"
+
+// Asks the compiler to inline a function into every caller even when it is
+// large, so that each caller gets a copy specialized to its arguments
+#ifdef __GNUC__
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define ALWAYS_INLINE inline
+#endif
+
+// Private helpers ------------------------------------------------------------
+
+// Writes x to p as a varint (7 bits per byte, lowest bits first, with the
+// high bit set on every byte but the last) and returns the position after it
+static unsigned char* writeVarint(unsigned char* p, unsigned int x) {
+    while(x >= 0x80) {
+        *p++ = (unsigned char)(x | 0x80);
+        x >>= 7;
+    }
+    *p++ = (unsigned char)x;
+    return p;
+}
 
-} GraphObj;
+// Returns the number of bytes writeVarint() uses for x
+static int varintLength(unsigned int x) {
+    int len = 1;
+    while(x >= 0x80) {
+        x >>= 7;
+        len++;
+    }
+    return len;
+}
+
+// Reads a varint from p into *x and returns the position after it
+static inline const unsigned char* readVarint(const unsigned char* p, unsigned int* x) {
+    unsigned int v = *p & 0x7f;
+    int shift = 7;
+    while(*p++ & 0x80) {
+        v |= (unsigned int)(*p & 0x7f) << shift;
+        shift += 7;
+    }
+    *x = v;
+    return p;
+}
+
+// Returns the number of bytes held by G and its Searches, which may be
+// allocating from their own threads
+static long memoryTotal(Graph G) {
+    return(__sync_fetch_and_add(&G->committed, 0) + G->listBytes);
+}
+
+// Records total as the most bytes G and its Searches have held, if it is
+static void notePeak(Graph G, long total) {
+    long peak = __sync_fetch_and_add(&G->peak, 0);
+    while(total>peak && !__sync_bool_compare_and_swap(&G->peak, peak, total)) {
+        peak = __sync_fetch_and_add(&G->peak, 0);
+    }
+}
+
+// Reserves the given number of bytes of the given kind for G and its
+// Searches, before they are allocated, and exits with an error if that
+// would take them over the memory budget of G. Searches reserve from their
+// own threads, so the bytes are taken with a compare-and-swap that fails
+// if another thread got there first, and the budget is checked again.
+// Reserving 0 bytes checks that the Lists haven't outgrown the budget.
+static void reserveMemory(Graph G, int kind, long bytes) {
+
+    long held = __sync_fetch_and_add(&G->committed, 0);
+    long total;
+    while(1) {
+        total = held + bytes + G->listBytes;
+        if(G->budget>0 && total>G->budget) {
+            printf("Graph Error: memory budget of %ld bytes exceeded, %ld bytes wanted\n", G->budget, total);
+            exit(1);
+        }
+        long seen = __sync_val_compare_and_swap(&G->committed, held, held+bytes);
+        if(seen == held) {
+            break;
+        }
+        held = seen;
+    }
+    __sync_fetch_and_add(&G->memory[kind], bytes);
+    notePeak(G, total);
+}
+
+// Gives back the given number of bytes of the given kind reserved for G
+// and its Searches by reserveMemory(), once they are freed
+static void releaseMemory(Graph G, int kind, long bytes) {
+    __sync_fetch_and_sub(&G->memory[kind], bytes);
+    __sync_fetch_and_sub(&G->committed, bytes);
+}
+
+// Exits with an error if the adjacency Lists of G, which charge their
+// bytes as they grow, have taken it over its memory budget
+static void checkBudget(Graph G) {
+    reserveMemory(G, MEMORY_ADJACENCY, 0);
+}
+
+// Returns a new array of n elements of the given size, allocated with the
+// given policy and counted as memory of the given kind held by G. Exits
+// with an error if there isn't enough memory for it, or it would take G
+// over its memory budget.
+static void* graphArray(Graph G, int kind, long n, size_t size, int policy) {
+
+    long bytes = (long)arrayFootprint(n * size, policy);
+    reserveMemory(G, kind, bytes);
+    void* A = newArray(n * size, policy);
+
+    // Make sure there was memory allocated for the array
+    if(A == NULL) {
+        releaseMemory(G, kind, bytes);
+        printf("Graph Error: unable to allocate %ld bytes\n", (long)(n * size));
+        exit(1);
+    }
+
+    return(A);
+}
+
+// Frees the array A, returned by graphArray() for the given kind of memory
+// held by G. Does nothing if A is NULL.
+static void graphFree(Graph G, int kind, void* A) {
+    releaseMemory(G, kind, (long)arrayBytes(A));
+    freeArray(A);
+}
+
+// Returns new heap memory of the given number of bytes, counted as memory
+// of the given kind held by G, for the objects that aren't arrays. Exits
+// with an error if there isn't enough memory, or it would take G over its
+// memory budget.
+static void* graphObject(Graph G, int kind, size_t bytes) {
+
+    reserveMemory(G, kind, (long)bytes);
+    void* p = malloc(bytes);
+
+    // Make sure there was memory allocated for the object
+    if(p == NULL) {
+        releaseMemory(G, kind, (long)bytes);
+        printf("Graph Error: unable to allocate %ld bytes\n", (long)bytes);
+        exit(1);
+    }
+
+    return(p);
+}
+
+// Returns a new empty List whose bytes are counted as adjacency held by G
+static List graphList(Graph G) {
+    List L = newList();
+    setListCounter(L, &G->listBytes);
+    return(L);
+}
+
+// Unmaps the file loaded into S by loadSearch(), if any, and gives S its
+// own arrays back so that it can run again
+static void releaseSnapshot(Search S) {
+
+    if(S->snapshot != NULL) {
+        unmapFile(S->snapshot, S->snapshotBytes);
+        S->parent = S->kept[0];
+        S->distance = S->kept[1];
+        S->queue = S->kept[2];
+        S->levelStart = S->kept[3];
+        S->snapshot = NULL;
+        S->snapshotBytes = 0;
+    }
+}
 
 // Constructors-Destructors ---------------------------------------------------
 
 // Returns a Graph pointing to a newly created GraphObj 
 // representing a graph having n vertices and no edges.
 Graph newGraph(int n) {
+    return(newGraphPolicy(n, ALLOC_DEFAULT));
+}
+
+// Same as newGraph(), but allocates the arrays of the graph and of
+// its Searches with the given policy, which is any combination of
+// the ALLOC_ flags in Memory.h. Searches are never interleaved, since
+// each one is meant to be used by a single thread.
+Graph newGraphPolicy(int n, int policy) {
 
     // Allocate memory for the graph
     Graph G = malloc(sizeof(GraphObj));
 
     // Make sure there was memory allocated for the graph
-    assert(G != NULL);
-
-    // Allocate memory for the neighbor, color, parent, and distance arrays
-    G->neighbor = malloc((n+1) * sizeof(List));
-    G->color = malloc((n+1) * sizeof(int));
-    G->parent = malloc((n+1) * sizeof(int));
-    G->distance = malloc((n+1) * sizeof(int));
+    if(G == NULL) {
+        printf("Graph Error: unable to allocate %ld bytes\n", (long)sizeof(GraphObj));
+        exit(1);
+    }
 
-    // Neighbor becomes an array of Lists, initialize the color 
-    // array to 0 (white), initialize the parent array to NIL 
-    // (undefined vertex) and the distance array to INF (infinity)
+    // Count the graph itself as adjacency, with no budget yet
+    for(int kind=0; kind<MEMORY_KINDS; kind++) {
+        G->memory[kind] = 0;
+    }
+    G->memory[MEMORY_ADJACENCY] = sizeof(GraphObj);
+    G->committed = sizeof(GraphObj);
+    G->listBytes = 0;
+    G->peak = 0;
+    G->budget = 0;
+
+    // Allocate memory for the neighbor array
+    G->policy = policy;
+    G->neighbor = graphArray(G, MEMORY_ADJACENCY, n+1, sizeof(List), policy);
+
+    // The graph is unweighted until a weighted edge is added
+    G->weight = NULL;
+    G->weighted = 0;
+    G->maxWeight = 1;
+
+    // Neighbor becomes an array of Lists
     for(int i=1; i<n+1; i++) {
-        G->neighbor[i] = newList();
-        G->color[i] = 0;
-        G->parent[i] = NIL;
-        G->distance[i] = INF;
+        G->neighbor[i] = graphList(G);
     }
 
     // The order is n (number of vertices)
-    // Initialize the size to 0 and source to NIL
+    // Initialize the size to 0
     G->order = n;
     G->size = 0;
-    G->source = NIL;
+
+    // Every edge added is kept until setDedup() is called
+    G->dedup = 0;
+    G->dropped = 0;
+
+    // The CSR index is built the first time it is needed
+    G->offset = NULL;
+    G->degree = NULL;
+    G->target = NULL;
+    G->cost = NULL;
+    G->indexed = 0;
+    G->directed = 0;
+    G->reverseOffset = NULL;
+    G->reverseTarget = NULL;
+    G->reversed = 0;
+    G->dirty = NULL;
+    G->dirtyFlag = NULL;
+    G->dirtyCount = -1;
+    G->summed = 0;
+    pthread_mutex_init(&G->lock, NULL);
+
+    // The graph starts out uncompressed
+    G->packed = NULL;
+    G->packOffset = NULL;
+    G->maxDegree = 0;
+
+    // Give the graph its own Search for BFS()
+    G->state = newSearch(G);
 
     return(G);
 
@@ -72,17 +442,34 @@ void freeGraph(Graph* pG) {
 
         int n = getOrder(*pG);
 
-        // Traverse through neighbor to free each List inside of it
-        for(int i=1; i<n+1; i++) {
-            freeList(&(*pG)->neighbor[i]);
+        // Traverse through neighbor to free each List inside of it,
+        // unless they were already freed by compressGraph()
+        if((*pG)->packed == NULL) {
+            for(int i=1; i<n+1; i++) {
+                freeList(&(*pG)->neighbor[i]);
+                if((*pG)->weight != NULL) {
+                    freeList(&(*pG)->weight[i]);
+                }
+            }
         }
 
-        // Free neighbor, color, parent, and distance arrays
+        // Free the neighbor array, the CSR index, the compressed
+        // adjacency and the Search
         // Free the graph and set it equal to NULL
-        free((*pG)->neighbor);
-        free((*pG)->color);
-        free((*pG)->parent);
-        free((*pG)->distance);
+        graphFree(*pG, MEMORY_ADJACENCY, (*pG)->neighbor);
+        graphFree(*pG, MEMORY_ADJACENCY, (*pG)->weight);
+        graphFree(*pG, MEMORY_ADJACENCY, (*pG)->offset);
+        graphFree(*pG, MEMORY_ADJACENCY, (*pG)->degree);
+        graphFree(*pG, MEMORY_ADJACENCY, (*pG)->target);
+        graphFree(*pG, MEMORY_ADJACENCY, (*pG)->cost);
+        graphFree(*pG, MEMORY_ADJACENCY, (*pG)->reverseOffset);
+        graphFree(*pG, MEMORY_ADJACENCY, (*pG)->reverseTarget);
+        graphFree(*pG, MEMORY_ADJACENCY, (*pG)->dirty);
+        graphFree(*pG, MEMORY_ADJACENCY, (*pG)->dirtyFlag);
+        graphFree(*pG, MEMORY_ADJACENCY, (*pG)->packed);
+        graphFree(*pG, MEMORY_ADJACENCY, (*pG)->packOffset);
+        freeSearch(&(*pG)->state);
+        pthread_mutex_destroy(&(*pG)->lock);
         free(*pG);
         *pG = NULL;
 
@@ -90,6 +477,135 @@ void freeGraph(Graph* pG) {
 
 }
 
+// Returns a new Search over the Graph G, with no BFS run yet
+Search newSearch(Graph G) {
+
+    // Check if the Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling newSearch() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    int n = getOrder(G);
+
+    // Allocate memory for the search, which counts as per-vertex state
+    Search S = graphObject(G, MEMORY_VERTEX, sizeof(SearchObj));
+
+    // Allocate memory for the parent and distance arrays
+    // and the frontier buffers
+    // Searches are local to one thread, so they are never interleaved
+    int policy = G->policy & ~ALLOC_INTERLEAVE;
+    S->graph = G;
+    S->parent = graphArray(G, MEMORY_VERTEX, n+1, sizeof(int), policy);
+    S->distance = graphArray(G, MEMORY_VERTEX, n+1, sizeof(int), policy);
+    S->queue = graphArray(G, MEMORY_VERTEX, n+1, sizeof(int), policy);
+    S->levelStart = graphArray(G, MEMORY_VERTEX, n+2, sizeof(int), policy);
+
+    // Initialize the parent array to NIL (undefined vertex)
+    // and the distance array to INF (infinity)
+    for(int i=1; i<n+1; i++) {
+        S->parent[i] = NIL;
+        S->distance[i] = INF;
+    }
+
+    // Initialize the source to NIL
+    S->levels = 0;
+    S->levelStart[0] = 0;
+    S->source = NIL;
+
+    // The scratch buffers are only allocated for compressed graphs
+    S->scratch = NULL;
+    S->scratchCost = NULL;
+    S->scratchSize = 0;
+
+    // Nothing is loaded from a file yet
+    S->snapshot = NULL;
+    S->snapshotBytes = 0;
+
+    // The path counts and DAG are only allocated when first wanted
+    S->counted = 0;
+    S->paths = NULL;
+    S->predStart = NULL;
+    S->pred = NULL;
+    S->predSize = 0;
+
+    // So are the arrays of searchBetween()
+    for(int side=0; side<2; side++) {
+        S->sideDistance[side] = NULL;
+        S->sideParent[side] = NULL;
+        S->sideQueue[side] = NULL;
+    }
+
+    return(S);
+}
+
+// Frees all dynamic memory associated with the Search
+// *pS, then sets the handle *pS to NULL.
+void freeSearch(Search* pS) {
+
+    // Checks if pS or its pointer is NULL
+    if(pS!=NULL && *pS!=NULL) {
+        releaseSnapshot(*pS);
+        graphFree((*pS)->graph, MEMORY_VERTEX, (*pS)->parent);
+        graphFree((*pS)->graph, MEMORY_VERTEX, (*pS)->distance);
+        graphFree((*pS)->graph, MEMORY_VERTEX, (*pS)->queue);
+        graphFree((*pS)->graph, MEMORY_VERTEX, (*pS)->levelStart);
+        graphFree((*pS)->graph, MEMORY_SCRATCH, (*pS)->scratch);
+        graphFree((*pS)->graph, MEMORY_SCRATCH, (*pS)->scratchCost);
+        graphFree((*pS)->graph, MEMORY_SCRATCH, (*pS)->paths);
+        graphFree((*pS)->graph, MEMORY_SCRATCH, (*pS)->predStart);
+        graphFree((*pS)->graph, MEMORY_SCRATCH, (*pS)->pred);
+        for(int side=0; side<2; side++) {
+            graphFree((*pS)->graph, MEMORY_SCRATCH, (*pS)->sideDistance[side]);
+            graphFree((*pS)->graph, MEMORY_SCRATCH, (*pS)->sideParent[side]);
+            graphFree((*pS)->graph, MEMORY_SCRATCH, (*pS)->sideQueue[side]);
+        }
+        releaseMemory((*pS)->graph, MEMORY_VERTEX, (long)sizeof(SearchObj));
+        free(*pS);
+        *pS = NULL;
+    }
+
+}
+
+// Returns a new array of n zeroed elements of the given size, counted as
+// memory of the given kind held by G, for the modules that keep state of
+// their own about G, so that it falls under the memory budget of G as well.
+// Exits with an error if there isn't enough memory for it, or it would take
+// G over its memory budget.
+void* newGraphArray(Graph G, int kind, long n, size_t size) {
+
+    // Check if the Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling newGraphArray() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    // Check if the kind is valid
+    if(kind<0 || kind>=MEMORY_KINDS) {
+        printf("Graph Error: newGraphArray() called on improper kind\n");
+        exit(1);
+    }
+
+    void* A = graphArray(G, kind, n, size, ALLOC_DEFAULT);
+    memset(A, 0, n * size);
+    return(A);
+}
+
+// Frees an array returned by newGraphArray() for G and the same kind.
+// Does nothing if A is NULL.
+void freeGraphArray(Graph G, int kind, void* A) {
+
+    // Check if the Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling freeGraphArray() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    if(A != NULL) {
+        graphFree(G, kind, A);
+    }
+}
+
 // Access functions -----------------------------------------------------------
 
 // Returns the number of vertices in this graph
@@ -116,359 +632,2611 @@ int getSize(Graph G) {
     return(G->size);
 }
 
-// Returns the source vertex most recently used in function 
-// BFS(), or NIL if BFS() has not yet been called.
-int getSource(Graph G) {
+// Returns true (1) if compressGraph() has been called on this
+// graph since it was created or last made null, otherwise false (0)
+int isCompressed(Graph G) {
 
     // Check if this Graph is NULL
     if(G == NULL) {
-        printf("Graph Error: calling getSource() on NULL Graph reference\n");
+        printf("Graph Error: calling isCompressed() on NULL Graph reference\n");
         exit(1);
     }
 
-    return(G->source);
+    return(G->packed != NULL);
 }
 
-// Returns the parent of vertex u in the Breadth-First tree 
-// created by BFS(), or NIL if BFS() has not yet been called.
-int getParent(Graph G, int u) {
+// Returns true (1) if a weighted edge has been added to this graph since
+// it was created or last made null, otherwise false (0)
+int isWeighted(Graph G) {
 
-    // Check if this Graph is empty
+    // Check if this Graph is NULL
     if(G == NULL) {
-        printf("Graph Error: calling getParent() on NULL Graph reference\n");
-        exit(1);
-    }
-
-    int par;
-    // Check if u is a valid vertex
-    if(1<=u && u<=getOrder(G)) {
-        par = G->parent[u];
-    } else {
-        printf("Graph Error: getParent() called on improper Graph");
+        printf("Graph Error: calling isWeighted() on NULL Graph reference\n");
         exit(1);
     }
 
-    return par;
+    return(G->weighted);
 }
 
-// Returns the distance from the most recent BFS source to 
-// vertex u, or INF if BFS() has not yet been called.
-int getDist(Graph G, int u) {
+// Returns true (1) if an arc has been added or removed on its own, without
+// its reverse, since this graph was created or last made null, so that its
+// adjacency lists may not be symmetric, otherwise false (0)
+int isDirected(Graph G) {
 
     // Check if this Graph is NULL
     if(G == NULL) {
-        printf("Graph Error: calling getDist() on NULL Graph reference\n");
+        printf("Graph Error: calling isDirected() on NULL Graph reference\n");
         exit(1);
     }
 
-    int dist;
-    // Check if u is a valid vertex
-    if(1<=u && u<=getOrder(G)) {
-        dist = G->distance[u];
-    } else {
-        printf("Graph Error: getDist() called on improper Graph");
+    return(G->directed);
+}
+
+// Returns the number of duplicate edges and self-loops dropped since the
+// graph was created or last made null, while setDedup() was in effect
+int getDropped(Graph G) {
+
+    // Check if this Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling getDropped() on NULL Graph reference\n");
         exit(1);
     }
 
-    return dist;
+    return(G->dropped);
 }
 
-// Appends to the List L the vertices of a shortest path in G from 
-// source to u, or appends to L the value NIL if no such path exists.
-// Note: BFS() must be called before getPath() because there needs to be a source vertex
-void getPath(List L, Graph G, int u) {
+// Returns the number of bytes of the given kind of memory held by G and
+// its Searches: MEMORY_ADJACENCY for the graph itself, its adjacency Lists,
+// CSR indexes and compressed adjacency, MEMORY_VERTEX for the arrays every
+// Search keeps per vertex (parents, distances, queue and levels), and
+// MEMORY_SCRATCH for buffers that only some kinds of search use, or that
+// only last for one call. MEMORY_KINDS gives all three together.
+long getMemory(Graph G, int kind) {
 
     // Check if this Graph is NULL
     if(G == NULL) {
-        printf("Graph Error: calling getPath() on NULL Graph reference\n");
+        printf("Graph Error: calling getMemory() on NULL Graph reference\n");
         exit(1);
     }
 
-    // The recursive function starts from the destination vertex and
-    // tries to reach back to the source vertex.
-    // Checks if BFS() was called and if u is a valid vertex.
-    if(getSource(G)!=NIL && 1<=u && u<=getOrder(G)) {
-        // If we have reached back to the source vertex, there
-        // is a path, so first append the source vertex to the List.     
-        if(u == getSource(G)) {
-            append(L, getSource(G));
-        // If the parent vertex of the path is NIL, reaching back to the
-        // source isn't possible (there is no path) and append NIL to the List.
-        } else if(G->parent[u] == NIL) {
-            append(L, NIL);
-        // Recursively call getPath() again to move closer back to the source.
-        // Append the current vertex to the List to create the path.
-        } else {
-            getPath(L, G, G->parent[u]);
-            append(L, u);
-        }
-    } else {
-        printf("Graph Error: getPath() called on improper Graph");
+    // Check if the kind is valid
+    if(kind<0 || kind>MEMORY_KINDS) {
+        printf("Graph Error: getMemory() called on improper kind\n");
         exit(1);
     }
 
+    if(kind == MEMORY_KINDS) {
+        return(memoryTotal(G));
+    }
+    return(__sync_fetch_and_add(&G->memory[kind], 0) + (kind==MEMORY_ADJACENCY ? G->listBytes : 0));
 }
 
-// Manipulation procedures ----------------------------------------------------
+// Returns the most bytes G and its Searches have held at any one time
+long getMemoryPeak(Graph G) {
 
-// Deletes all edges of G, restoring it to its original (no edge) state
-void makeNull(Graph G) {
+    // Check if this Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling getMemoryPeak() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    notePeak(G, memoryTotal(G));
+    return(__sync_fetch_and_add(&G->peak, 0));
+}
+
+// Returns about how many bytes the CSR index of G takes up, or will take
+// up once it is built for the edges G has now. Searching needs the index
+// on top of the adjacency Lists, unless the graph is compressed, when it
+// is 0.
+long getIndexBytes(Graph G) {
 
     // Check if this Graph is NULL
     if(G == NULL) {
-        printf("Graph Error: calling makeNull() on NULL Graph reference\n");
+        printf("Graph Error: calling getIndexBytes() on NULL Graph reference\n");
         exit(1);
     }
-    
+
+    if(G->packed != NULL) {
+        return 0;
+    }
+    if(G->indexed) {
+        return(arrayBytes(G->offset) + arrayBytes(G->degree) + arrayBytes(G->target)
+               + arrayBytes(G->cost) + arrayBytes(G->dirty) + arrayBytes(G->dirtyFlag));
+    }
+
+    // The offsets, degrees, neighbors and weights, and the dirty vertices
     int n = getOrder(G);
-    
-    // Call the clear function in List ADT for the neighbor array, initialize the 
-    // color array back to 0, the parent array to NIL, and the distance array to INF.
+    long entries = 0;
     for(int i=1; i<n+1; i++) {
-        clear(G->neighbor[i]);
-        G->color[i] = 0;
-        G->parent[i] = NIL;
-        G->distance[i] = INF;
+        entries += length(G->neighbor[i]);
     }
-
-    // Initialize order to n, size to 0, and source to NIL
-    G->order = n;
-    G->size = 0;
-    G->source = NIL;
+    return((n+2) * (long)sizeof(long) + (n+1) * (long)sizeof(int)
+           + (entries+1) * (long)sizeof(int) * (G->weighted ? 2 : 1)
+           + (n/8+1) * (long)sizeof(int) + (n+1));
 }
 
-// Inserts a new edge joining u to v, i.e. u is added to 
-// the adjacency List of v, and v to the adjacency List of u. 
-// Maintains list in sorted order by increasing labels.
-void addEdge(Graph G, int u, int v) {
+// Returns the source vertex most recently used in function 
+// BFS(), or NIL if BFS() has not yet been called.
+int getSource(Graph G) {
 
-    // Check if the Graph is NULL
+    // Check if this Graph is NULL
     if(G == NULL) {
-        printf("Graph Error: calling addEdge() on NULL Graph reference\n");
+        printf("Graph Error: calling getSource() on NULL Graph reference\n");
         exit(1);
     }
 
-    // Get the adjacency lists of vertices u and v
-    List M = G->neighbor[u];
-    List N = G->neighbor[v];
+    return(searchSource(G->state));
+}
 
-    // Check if u and v are valid vertices
-    if(1<=u && u<=getOrder(G) && 1<=v && v<=getOrder(G)) {
+// Returns the parent of vertex u in the Breadth-First tree 
+// created by BFS(), or NIL if BFS() has not yet been called.
+int getParent(Graph G, int u) {
 
-        // Increment the number of edges by 1
-        G->size = G->size + 1;
+    // Check if this Graph is empty
+    if(G == NULL) {
+        printf("Graph Error: calling getParent() on NULL Graph reference\n");
+        exit(1);
+    }
 
-        // Add v to u's adjacency list first.
-        // Just append v if the adjacency list for u is empty.
-        if(length(M) == 0) {
-            append(M, v);
-        } else {
-            // Start at the front of u's adjacency list
-            moveFront(M);
-            // Go through u's adjacency list to find 
-            // the right spot to append v and maintain sorted order.
-            while(place(M)>=0 && get(M)<v) {
-                // Move the cursor
-                moveNext(M);
-            }
-            // Insert before the cursor if we found the right spot
-            // to append v and maintain sorted order.
-            if(place(M) >= 0) {
-                insertBefore(M, v);
-            } else {
-                // If we went through all of the adjacent vertices 
-                // in u then just append v at the end of the list.
-                append(M,v);
-            }
-        }
+    return(searchParent(G->state, u));
+}
 
-        // Add u to v's adjacency list now.
-        // Just append u if the adjacency list for v is empty.
-        if(length(N) == 0) {
-            append(N, u);
-        } else {
-            // Start at the front of v's adjacency list
-            moveFront(N);
-            // Go through v's adjacency list to find 
-            // the right spot to append u and maintain sorted order.
-            while(place(N)>=0 && get(N)<u) {
-                // Move the cursor
-                moveNext(N);
-            }
-            // Insert before the cursor if we found the right spot
-            // to append u and maintain sorted order.
-            if(place(N) >= 0) {
-                insertBefore(N, u);
-            } else {
-                // If we went through all of the adjacent vertices in 
-                // v then just append u at the end of the list
-                append(N,u);
-            }
-        }
+// Returns the distance from the most recent BFS source to 
+// vertex u, or INF if BFS() has not yet been called.
+int getDist(Graph G, int u) {
 
-    } else {
-        printf("Graph Error: addEdge() called on improper Graph");
+    // Check if this Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling getDist() on NULL Graph reference\n");
         exit(1);
     }
+
+    return(searchDist(G->state, u));
 }
 
-// Inserts a new directed edge from u to v, i.e. v is added to the 
-// adjacency List of u (but not u to the adjacency List of v)
-void addArc(Graph G, int u, int v) {
+// Appends to the List L the vertices of a shortest path in G from 
+// source to u, or appends to L the value NIL if no such path exists.
+// Note: BFS() must be called before getPath() because there needs to be a source vertex
+void getPath(List L, Graph G, int u) {
 
-    // Check if the Graph is NULL
+    // Check if this Graph is NULL
     if(G == NULL) {
-        printf("Graph Error: calling addArc() on NULL Graph reference\n");
+        printf("Graph Error: calling getPath() on NULL Graph reference\n");
         exit(1);
     }
 
-    // Get the adjacency list of u
-    List M = G->neighbor[u];
-
-    // Check if u and v are valid vertices
-    if(1<=u && u<=getOrder(G) && 1<=v && v<=getOrder(G)) {
-
-        // Increment the number of edges by 1
-        G->size = G->size + 1;
+    searchPath(L, G->state, u);
+}
 
-        // Just append v if the adjacency list for u is empty
-        if(length(M) == 0) {
-            append(M, v);
-        } else {
-            // Start at the front of u's adjacency list
-            moveFront(M);
-            // Go through u's adjacency list to find 
-            // the right spot to append v and maintain sorted order
-            while(place(M)>=0 && get(M)<v) {
-                // Move the cursor
-                moveNext(M);
-            }
-            // Insert before the cursor if we found the right spot
-            // to append v and maintain sorted order
-            if(place(M) >= 0) {
-                insertBefore(M, v);
-            } else {
-                // If we went through all of the adjacency vertices in u 
-                // then just append v at the end of the list
-                append(M,v);
-            }
-        }
+// Returns the number of levels reached by the most recent call to BFS()
+// or BFSDepth(), or 0 if neither has been called yet.
+int getLevels(Graph G) {
 
-    } else {
-        printf("Graph Error: addArc() called on improper Graph");
+    // Check if this Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling getLevels() on NULL Graph reference\n");
         exit(1);
     }
+
+    return(searchLevels(G->state));
 }
 
-// Runs the BFS algorithm on the Graph G with source s, 
-// setting the color, distance, parent, and source fields of G accordingly.
-void BFS(Graph G, int s) {
+// Returns the number of vertices at distance d from the most recent BFS source
+int getLevelSize(Graph G, int d) {
 
     // Check if this Graph is NULL
     if(G == NULL) {
-        printf("Graph Error: calling addArc() on NULL Graph reference\n");
+        printf("Graph Error: calling getLevelSize() on NULL Graph reference\n");
         exit(1);
     }
 
-    // Checks if s is a valid vertex
-    if(s<1 || s>getOrder(G)) {
-        printf("Graph Error: BFS() called on improper source");
-        exit(1);
-    }
+    return(searchLevelSize(G->state, d));
+}
 
-    int n = getOrder(G);
+// Returns the vertices at distance d from the most recent BFS source, in the
+// order BFS discovered them. The array belongs to G and is only valid until
+// the next call to BFS(), BFSDepth() or makeNull().
+const int* getLevel(Graph G, int d) {
 
-    // Initialize all colors to white, all parents to NIL, and all distances to INF
-    for(int i=1; i<n+1; i++) {
-        G->color[i] = 0;
-        G->parent[i] = NIL;
-        G->distance[i] = INF;
+    // Check if this Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling getLevel() on NULL Graph reference\n");
+        exit(1);
     }
 
-    // Change the color of the source to gray because we've discovered
-    // the vertex itself, but not its neighbors yet
-    G->color[s] = 1;
-    // Set the distance from the source to 0
-    G->distance[s] = 0;
-    // Set the parent of the source to NIL
-    G->parent[s] = NIL;
-    // Set the source accordingly
-    G->source = s;
-
-    // Initialize a List, which implements the FIFO queue, and append the source to it
-    List Q = newList();
-    append(Q, s);
-
-    // Run the loop while the List isn't empty
-    while(length(Q) != 0) {
+    return(searchLevel(G->state, d));
+}
 
-        // Get the front vertex in the List
-        int x = front(Q);
+// Returns the Search that holds the result of BFS() on G
+Search getSearch(Graph G) {
 
-        // Delete the front vertex in the List
-        deleteFront(Q);
+    // Check if this Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling getSearch() on NULL Graph reference\n");
+        exit(1);
+    }
 
-        // Get the adjacency list of the front vertex in the List
-        List Adj = G->neighbor[x];
+    return(G->state);
+}
 
-        // Check if the adjacency list of the front
-        // vertex in the List is empty
-        if(length(Adj) != 0) {
+// Returns the source vertex most recently used by this Search,
+// or NIL if it has not run yet.
+int searchSource(Search S) {
 
-            // Traverse through the adjacency list of the front vertex in the List
-            for(moveFront(Adj); place(Adj)>=0; moveNext(Adj)) {
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling searchSource() on NULL Search reference\n");
+        exit(1);
+    }
 
-                // Get the vertex at the cursor of the adjacency list
-                int y = get(Adj);
+    return(S->source);
+}
 
-                // Check if the vertex is undiscovered
-                if(G->color[y] == 0) {
-                    // Change the color of the vertex to grey
-                    G->color[y] = 1;
+// Returns the parent of vertex u in the Breadth-First tree
+// of this Search, or NIL if it has not run yet.
+int searchParent(Search S, int u) {
 
-                    // Set the distance of the vertex to its parent's distance plus 1
-                    G->distance[y] = G->distance[x] + 1;
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling searchParent() on NULL Search reference\n");
+        exit(1);
+    }
 
-                    // Set the parent of the vertex to the front vertex in the List
-                    G->parent[y] = x;
+    // Check if u is a valid vertex
+    if(u<1 || u>getOrder(S->graph)) {
+        printf("Graph Error: getParent() called on improper Graph");
+        exit(1);
+    }
+
+    return(S->parent[u]);
+}
+
+// Returns the distance from the source of this Search to
+// vertex u, or INF if it has not run yet.
+int searchDist(Search S, int u) {
+
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling searchDist() on NULL Search reference\n");
+        exit(1);
+    }
+
+    // Check if u is a valid vertex
+    if(u<1 || u>getOrder(S->graph)) {
+        printf("Graph Error: getDist() called on improper Graph");
+        exit(1);
+    }
+
+    return(S->distance[u]);
+}
+
+// Appends to the List L the vertices of a shortest path from the source
+// of this Search to u, or appends to L the value NIL if no such path exists.
+void searchPath(List L, Search S, int u) {
+
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling searchPath() on NULL Search reference\n");
+        exit(1);
+    }
+
+    // Checks if BFS() was called and if u is a valid vertex.
+    if(S->source==NIL || u<1 || u>getOrder(S->graph)) {
+        printf("Graph Error: getPath() called on improper Graph");
+        exit(1);
+    }
+
+    // Walk back from the destination vertex towards the source, gathering
+    // the path backwards, in a buffer on the stack unless it is long.
+    // If the walk ends at a vertex whose parent is NIL other than the
+    // source, reaching back to the source isn't possible (there is no
+    // path), and NIL comes first in its place.
+    int local[256];
+    int* path = local;
+    int room = 256;
+    int count = 0;
+    int x = u;
+    while(1) {
+        if(count == room) {
+            int* more = graphArray(S->graph, MEMORY_SCRATCH, 2L*room, sizeof(int), ALLOC_DEFAULT);
+            memcpy(more, path, count * sizeof(int));
+            if(path != local) {
+                graphFree(S->graph, MEMORY_SCRATCH, path);
+            }
+            path = more;
+            room *= 2;
+        }
+        if(x == S->source) {
+            path[count++] = x;
+            break;
+        }
+        if(S->parent[x] == NIL) {
+            path[count++] = NIL;
+            break;
+        }
+        path[count++] = x;
+        x = S->parent[x];
+    }
+
+    // Reverse the path in place and append it all at once
+    for(int i=0, j=count-1; i<j; i++, j--) {
+        int t = path[i];
+        path[i] = path[j];
+        path[j] = t;
+    }
+    appendArray(L, path, count);
+    if(path != local) {
+        graphFree(S->graph, MEMORY_SCRATCH, path);
+    }
+
+}
+
+// Returns the number of levels reached by the most recent
+// BFS of this Search, or 0 if it has not run yet.
+int searchLevels(Search S) {
+
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling searchLevels() on NULL Search reference\n");
+        exit(1);
+    }
+
+    return(S->levels);
+}
+
+// Returns the number of vertices at distance d from the source of this Search
+int searchLevelSize(Search S, int d) {
+
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling searchLevelSize() on NULL Search reference\n");
+        exit(1);
+    }
+
+    // Check if d is a level reached by the most recent BFS
+    if(d<0 || d>=S->levels) {
+        printf("Graph Error: getLevelSize() called on improper level");
+        exit(1);
+    }
+
+    return(S->levelStart[d+1] - S->levelStart[d]);
+}
+
+// Returns the vertices at distance d from the source of this Search, in the
+// order they were discovered. The array belongs to S and is only valid
+// until S runs again.
+const int* searchLevel(Search S, int d) {
+
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling searchLevel() on NULL Search reference\n");
+        exit(1);
+    }
+
+    // Check if d is a level reached by the most recent BFS
+    if(d<0 || d>=S->levels) {
+        printf("Graph Error: getLevel() called on improper level");
+        exit(1);
+    }
+
+    return(S->queue + S->levelStart[d]);
+}
+
+// Manipulation procedures ----------------------------------------------------
+
+// Deletes all edges of G, restoring it to its original (no edge) state
+void makeNull(Graph G) {
+
+    // Check if this Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling makeNull() on NULL Graph reference\n");
+        exit(1);
+    }
+    
+    int n = getOrder(G);
+
+    // The Search of G gets its own arrays back if a file was loaded into it
+    releaseSnapshot(G->state);
+
+    // A compressed graph gets its (empty) adjacency Lists back
+    if(G->packed != NULL) {
+        for(int i=1; i<n+1; i++) {
+            G->neighbor[i] = graphList(G);
+        }
+        graphFree(G, MEMORY_ADJACENCY, G->packed);
+        graphFree(G, MEMORY_ADJACENCY, G->packOffset);
+        G->packed = NULL;
+        G->packOffset = NULL;
+        G->maxDegree = 0;
+    } else if(G->weight != NULL) {
+        // The graph goes back to being unweighted
+        for(int i=1; i<n+1; i++) {
+            freeList(&G->weight[i]);
+        }
+    }
+    graphFree(G, MEMORY_ADJACENCY, G->weight);
+    graphFree(G, MEMORY_ADJACENCY, G->cost);
+    G->weight = NULL;
+    G->cost = NULL;
+    G->weighted = 0;
+    G->maxWeight = 1;
+    
+    // Call the clear function in List ADT for the neighbor array, initialize
+    // the parent array back to NIL and the distance array to INF.
+    for(int i=1; i<n+1; i++) {
+        clear(G->neighbor[i]);
+        G->state->parent[i] = NIL;
+        G->state->distance[i] = INF;
+    }
+
+    // Initialize order to n, size to 0, and source to NIL
+    G->order = n;
+    G->size = 0;
+    G->dropped = 0;
+    G->indexed = 0;
+    G->directed = 0;
+    G->reversed = 0;
+    G->dirtyCount = -1;
+    G->summed = 0;
+    G->state->source = NIL;
+    G->state->levels = 0;
+    G->state->counted = 0;
+}
+
+// Records that the adjacency List of u has changed, so its slice of
+// the CSR index must be copied again before the next search, and the
+// checksum of the graph worked out again
+static void markDirty(Graph G, int u) {
+
+    G->indexed = 0;
+    G->reversed = 0;
+    G->summed = 0;
+
+    // Give up on tracking single vertices once an eighth of them have
+    // changed, since rebuilding the whole index is then just as quick
+    if(G->dirtyCount>=0 && !G->dirtyFlag[u]) {
+        if(G->dirtyCount >= getOrder(G)/8 + 1) {
+            G->dirtyCount = -1;
+        } else {
+            G->dirtyFlag[u] = 1;
+            G->dirty[G->dirtyCount++] = u;
+        }
+    }
+}
+
+// Gives every adjacency List of G a matching List of weights, with
+// weight 1 for each edge added before the graph became weighted
+static void makeWeighted(Graph G) {
+
+    int n = getOrder(G);
+
+    G->weight = graphArray(G, MEMORY_ADJACENCY, n+1, sizeof(List), G->policy);
+    for(int i=1; i<n+1; i++) {
+        G->weight[i] = graphList(G);
+        for(int j=0; j<length(G->neighbor[i]); j++) {
+            append(G->weight[i], 1);
+        }
+    }
+    G->weighted = 1;
+    G->summed = 0;
+    checkBudget(G);
+}
+
+// Inserts v into the adjacency List of u, and w into the matching position
+// of its List of weights if the graph is weighted. Maintains list in sorted
+// order by increasing labels. Returns true (1) if v was inserted, or false
+// (0) if the graph drops duplicates and v was in the List already.
+static int insertNeighbor(Graph G, int u, int v, int w) {
+
+    // Get the adjacency list of u and its weights, if any
+    List M = G->neighbor[u];
+    List W = G->weighted ? G->weight[u] : NULL;
+
+    // Just append v if the adjacency list for u is empty
+    if(length(M) == 0) {
+        append(M, v);
+        if(W != NULL) {
+            append(W, w);
+        }
+        return 1;
+    }
+
+    // Start at the front of u's adjacency list
+    moveFront(M);
+    if(W != NULL) {
+        moveFront(W);
+    }
+    // Go through u's adjacency list to find 
+    // the right spot to append v and maintain sorted order,
+    // keeping the cursor of the weights in step
+    while(place(M)>=0 && get(M)<v) {
+        // Move the cursor
+        moveNext(M);
+        if(W != NULL) {
+            moveNext(W);
+        }
+    }
+    // Leave the List alone if v is already in it and duplicates are dropped
+    if(G->dedup && place(M)>=0 && get(M)==v) {
+        return 0;
+    }
+    // Insert before the cursor if we found the right spot
+    // to append v and maintain sorted order
+    if(place(M) >= 0) {
+        insertBefore(M, v);
+        if(W != NULL) {
+            insertBefore(W, w);
+        }
+    } else {
+        // If we went through all of the adjacent vertices in u 
+        // then just append v at the end of the list
+        append(M, v);
+        if(W != NULL) {
+            append(W, w);
+        }
+    }
+    return 1;
+}
+
+// Adds the edge (or arc, if both is false) joining u to v with weight w,
+// on behalf of the public function called name
+static void insertEdge(Graph G, int u, int v, int w, int both, char* name) {
+
+    // Check if the Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling %s() on NULL Graph reference\n", name);
+        exit(1);
+    }
+
+    // Check if the Graph has been compressed, which makes it read-only
+    if(G->packed != NULL) {
+        printf("Graph Error: calling %s() on compressed Graph\n", name);
+        exit(1);
+    }
+
+    // Check if u and v are valid vertices and w is a valid weight
+    if(u<1 || u>getOrder(G) || v<1 || v>getOrder(G) || w<0) {
+        printf("Graph Error: %s() called on improper Graph", name);
+        exit(1);
+    }
+
+    // An arc on its own may leave the adjacency Lists unsymmetric
+    if(!both) {
+        G->directed = 1;
+    }
+
+    // Drop self-loops if duplicates are being dropped
+    if(G->dedup && u==v) {
+        G->dropped++;
+        return;
+    }
+
+    // A weight other than 1 makes the graph weighted
+    if(w!=1 && !G->weighted) {
+        makeWeighted(G);
+    }
+    if(w > G->maxWeight) {
+        G->maxWeight = w;
+    }
+
+    // Add v to u's adjacency list first, then u to v's if it is an edge,
+    // marking the CSR index as out of date
+    int added = insertNeighbor(G, u, v, w);
+    markDirty(G, u);
+    if(both) {
+        added |= insertNeighbor(G, v, u, w);
+        markDirty(G, v);
+    }
+
+    // Increment the number of edges by 1, unless it was there already
+    if(added) {
+        G->size = G->size + 1;
+    } else {
+        G->dropped++;
+    }
+    checkBudget(G);
+}
+
+// Inserts a new edge joining u to v, i.e. u is added to 
+// the adjacency List of v, and v to the adjacency List of u. 
+// Maintains list in sorted order by increasing labels.
+void addEdge(Graph G, int u, int v) {
+    insertEdge(G, u, v, 1, 1, "addEdge");
+}
+
+// Inserts a new directed edge from u to v, i.e. v is added to the 
+// adjacency List of u (but not u to the adjacency List of v)
+void addArc(Graph G, int u, int v) {
+    insertEdge(G, u, v, 1, 0, "addArc");
+}
+
+// Same as addEdge(), but the edge has weight w, which must not be negative.
+// Edges added by addEdge() have weight 1.
+void addWeightedEdge(Graph G, int u, int v, int w) {
+    insertEdge(G, u, v, w, 1, "addWeightedEdge");
+}
+
+// Same as addArc(), but the arc has weight w, which must not be negative.
+// Arcs added by addArc() have weight 1.
+void addWeightedArc(Graph G, int u, int v, int w) {
+    insertEdge(G, u, v, w, 0, "addWeightedArc");
+}
+
+// Removes one occurrence of v from the adjacency List of u, along with
+// the weight of that edge. Returns true (1) if v was found, otherwise 0.
+static int removeNeighbor(Graph G, int u, int v) {
+
+    List M = G->neighbor[u];
+    List W = G->weighted ? G->weight[u] : NULL;
+
+    // Go through u's adjacency list until v or a larger label turns up,
+    // keeping the cursor of the weights in step
+    moveFront(M);
+    if(W != NULL) {
+        moveFront(W);
+    }
+    while(place(M)>=0 && get(M)<v) {
+        moveNext(M);
+        if(W != NULL) {
+            moveNext(W);
+        }
+    }
+
+    // Delete v if it is there
+    if(place(M)>=0 && get(M)==v) {
+        delete(M);
+        if(W != NULL) {
+            delete(W);
+        }
+        return 1;
+    }
+    return 0;
+}
+
+// Removes the edge (or arc, if both is false) joining u to v, on behalf of
+// the public function called name. Returns true (1) if it was there.
+static int deleteEdge(Graph G, int u, int v, int both, char* name) {
+
+    // Check if the Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling %s() on NULL Graph reference\n", name);
+        exit(1);
+    }
+
+    // Check if the Graph has been compressed, which makes it read-only
+    if(G->packed != NULL) {
+        printf("Graph Error: calling %s() on compressed Graph\n", name);
+        exit(1);
+    }
+
+    // Check if u and v are valid vertices
+    if(u<1 || u>getOrder(G) || v<1 || v>getOrder(G)) {
+        printf("Graph Error: %s() called on improper Graph", name);
+        exit(1);
+    }
+
+    // Remove v from u's adjacency list, then u from v's if it is an edge
+    if(!removeNeighbor(G, u, v)) {
+        return 0;
+    }
+    markDirty(G, u);
+    if(!both) {
+        G->directed = 1;
+    }
+    if(both) {
+        removeNeighbor(G, v, u);
+        markDirty(G, v);
+    }
+
+    // Decrement the number of edges by 1
+    G->size = G->size - 1;
+    return 1;
+}
+
+// Removes one edge joining u to v, i.e. u is removed from the adjacency
+// List of v, and v from the adjacency List of u. Returns true (1) if there
+// was such an edge, otherwise false (0).
+int removeEdge(Graph G, int u, int v) {
+    return(deleteEdge(G, u, v, 1, "removeEdge"));
+}
+
+// Removes one directed edge from u to v, i.e. v is removed from the
+// adjacency List of u. Returns true (1) if there was such an edge,
+// otherwise false (0).
+int removeArc(Graph G, int u, int v) {
+    return(deleteEdge(G, u, v, 0, "removeArc"));
+}
+
+// Private Change type
+// One change to one adjacency List: v is added to (or removed from) the
+// List of u. counted is false (0) for the second half of an edge, which
+// mustn't change the number of edges again.
+typedef struct Change {
+    int u;
+    int v;
+    int w;
+    int removed;
+    int counted;
+} Change;
+
+// Orders Changes by u, then v, with removals before additions, for qsort()
+static int compareChanges(const void* a, const void* b) {
+    const Change* x = a;
+    const Change* y = b;
+    if(x->u != y->u) {
+        return(x->u < y->u ? -1 : 1);
+    }
+    if(x->v != y->v) {
+        return(x->v < y->v ? -1 : 1);
+    }
+    return(y->removed - x->removed);
+}
+
+// Applies a batch of changes to G, on behalf of the public function called
+// name. Each vertex whose adjacency List changes is merged with its sorted
+// changes in a single pass, rather than being searched once per change.
+static void applyChanges(Graph G, List add, List weights, List remove, int both, char* name) {
+
+    // Check if the Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling %s() on NULL Graph reference\n", name);
+        exit(1);
+    }
+
+    // Check if the Graph has been compressed, which makes it read-only
+    if(G->packed != NULL) {
+        printf("Graph Error: calling %s() on compressed Graph\n", name);
+        exit(1);
+    }
+
+    // Check that the Lists hold whole pairs, with one weight per pair added
+    int adds = add!=NULL ? length(add)/2 : 0;
+    int removes = remove!=NULL ? length(remove)/2 : 0;
+    if((add!=NULL && length(add)%2!=0) || (remove!=NULL && length(remove)%2!=0)
+       || (weights!=NULL && length(weights)!=adds)) {
+        printf("Graph Error: %s() called with improper Lists", name);
+        exit(1);
+    }
+
+    // Arcs on their own may leave the adjacency Lists unsymmetric
+    if(!both && adds+removes>0) {
+        G->directed = 1;
+    }
+
+    // Turn every edge into one change per endpoint
+    int n = getOrder(G);
+    int count = 0;
+    Change* C = graphArray(G, MEMORY_SCRATCH, (long)(adds + removes) * (both ? 2 : 1) + 1, sizeof(Change), ALLOC_DEFAULT);
+    for(int pass=0; pass<2; pass++) {
+        List L = pass==0 ? add : remove;
+        if(L == NULL) {
+            continue;
+        }
+        if(pass==0 && weights!=NULL) {
+            moveFront(weights);
+        }
+        for(moveFront(L); place(L)>=0; moveNext(L)) {
+            int u = get(L);
+            moveNext(L);
+            int v = get(L);
+            int w = 1;
+            if(pass==0 && weights!=NULL) {
+                w = get(weights);
+                moveNext(weights);
+            }
+            if(u<1 || u>n || v<1 || v>n || w<0) {
+                printf("Graph Error: %s() called on improper Graph", name);
+                exit(1);
+            }
+            // Drop self-loops if duplicates are being dropped
+            if(pass==0 && G->dedup && u==v) {
+                G->dropped++;
+                continue;
+            }
+            Change c = { u, v, w, pass, 1 };
+            C[count++] = c;
+            if(both) {
+                Change d = { v, u, w, pass, 0 };
+                C[count++] = d;
+            }
+            // A weight other than 1 makes the graph weighted
+            if(w!=1 && !G->weighted) {
+                makeWeighted(G);
+            }
+            if(w > G->maxWeight) {
+                G->maxWeight = w;
+            }
+        }
+    }
+    qsort(C, count, sizeof(Change), compareChanges);
+
+    // Rebuild the adjacency List of each vertex with changes by merging
+    // its old List with them. Removals only match edges that were already
+    // there, so a batch that removes and adds the same edge replaces it.
+    for(int k=0; k<count; ) {
+
+        int u = C[k].u;
+        int end = k;
+        while(end<count && C[end].u==u) {
+            end++;
+        }
+
+        List M = G->neighbor[u];
+        List W = G->weighted ? G->weight[u] : NULL;
+        List N = graphList(G);
+        List X = G->weighted ? graphList(G) : NULL;
+        int r = k;
+
+        if(W != NULL) {
+            moveFront(W);
+        }
+        for(moveFront(M); place(M)>=0 || r<end; ) {
+
+            int x = place(M)>=0 ? get(M) : 0;
+
+            // Skip past changes for labels less than x, adding the new edges
+            // and counting the removals that don't match anything. If
+            // duplicates are dropped, so are new edges that are already
+            // there or were just added.
+            if(r<end && (place(M)<0 || C[r].v<x || (C[r].v==x && !C[r].removed))) {
+                if(!C[r].removed && G->dedup && (C[r].v==x || (length(N)>0 && back(N)==C[r].v))) {
+                    if(C[r].counted) {
+                        G->dropped++;
+                    }
+                } else if(!C[r].removed) {
+                    append(N, C[r].v);
+                    if(X != NULL) {
+                        append(X, C[r].w);
+                    }
+                    if(C[r].counted) {
+                        G->size++;
+                    }
+                }
+                r++;
+                continue;
+            }
+
+            // Drop x if a removal matches it, otherwise keep it
+            if(r<end && C[r].v==x && C[r].removed) {
+                if(C[r].counted) {
+                    G->size--;
+                }
+                r++;
+            } else {
+                append(N, x);
+                if(X != NULL) {
+                    append(X, get(W));
+                }
+            }
+            moveNext(M);
+            if(W != NULL) {
+                moveNext(W);
+            }
+        }
+
+        // Swap the merged Lists in for the old ones
+        freeList(&G->neighbor[u]);
+        G->neighbor[u] = N;
+        if(X != NULL) {
+            freeList(&G->weight[u]);
+            G->weight[u] = X;
+        }
+        markDirty(G, u);
+
+        k = end;
+    }
+
+    graphFree(G, MEMORY_SCRATCH, C);
+    checkBudget(G);
+}
+
+// Applies a batch of edge changes to G. add and remove hold pairs of
+// vertices u v, one pair per edge, and either may be NULL. weights, if
+// not NULL, holds the weight of each edge added, which is 1 otherwise.
+// Edges in remove are taken away before those in add are put in, and a
+// removal with no matching edge is ignored. Each changed adjacency List is
+// merged with its changes in one pass, and only the changed vertices of
+// the CSR index are updated, so a small batch costs far less than a rebuild.
+void updateEdges(Graph G, List add, List weights, List remove) {
+    applyChanges(G, add, weights, remove, 1, "updateEdges");
+}
+
+// Same as updateEdges(), but for directed edges from u to v
+void updateArcs(Graph G, List add, List weights, List remove) {
+    applyChanges(G, add, weights, remove, 0, "updateArcs");
+}
+
+// Adds the m edges joining edge[2i] to edge[2i+1], with weights weight[i]
+// if weight isn't NULL, leaving the graph just as adding them one at a time
+// with addEdge() or addWeightedEdge(), in order, would. The edges are sorted
+// into place all at once by two counting sorts, so filling an empty graph
+// this way takes time linear in its size rather than in the sum of the
+// squares of its degrees.
+void addEdges(Graph G, const int* edge, const int* weight, long m) {
+
+    // Check if the Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling addEdges() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    // Check if the Graph has been compressed, which makes it read-only
+    if(G->packed != NULL) {
+        printf("Graph Error: calling addEdges() on compressed Graph\n");
+        exit(1);
+    }
+
+    // Every edge is one entry in the adjacency List of each end, and
+    // entries are numbered 2i from u to v and 2i+1 from v to u, so they
+    // can be ordered by index alone
+    if(m > UINT_MAX/2) {
+        printf("Graph Error: addEdges() called with too many edges\n");
+        exit(1);
+    }
+
+    // Check if every vertex and weight is valid
+    int n = getOrder(G);
+    for(long i=0; i<m; i++) {
+        int u = edge[2*i], v = edge[2*i+1];
+        int w = weight!=NULL ? weight[i] : 1;
+        if(u<1 || u>n || v<1 || v>n || w<0) {
+            printf("Graph Error: addEdges() called on improper Graph");
+            exit(1);
+        }
+        // A weight other than 1 makes the graph weighted, unless the edge
+        // is a self-loop about to be dropped
+        if(G->dedup && u==v) {
+            continue;
+        }
+        if(w!=1 && !G->weighted) {
+            makeWeighted(G);
+        }
+        if(w > G->maxWeight) {
+            G->maxWeight = w;
+        }
+    }
+
+    // Order the entries by the vertex they lead to, then stably by the
+    // vertex whose List they go in, which leaves each List's entries
+    // sorted and, among equal neighbors, in the order they were added.
+    // Self-loops are dropped here if duplicates are being dropped.
+    long* start = graphArray(G, MEMORY_SCRATCH, n+2, sizeof(long), ALLOC_DEFAULT);
+    unsigned int* byTarget = graphArray(G, MEMORY_SCRATCH, 2*m+1, sizeof(unsigned int), ALLOC_DEFAULT);
+    unsigned int* bySource = graphArray(G, MEMORY_SCRATCH, 2*m+1, sizeof(unsigned int), ALLOC_DEFAULT);
+    memset(start, 0, (n+2) * sizeof(long));
+    long count = 0;
+    for(long e=0; e<2*m; e++) {
+        if(G->dedup && edge[e]==edge[e^1]) {
+            G->dropped += (e%2==0);
+            continue;
+        }
+        start[edge[e^1]+1]++;
+        count++;
+    }
+    for(int x=1; x<n+1; x++) {
+        start[x+1] += start[x];
+    }
+    for(long e=0; e<2*m; e++) {
+        if(!(G->dedup && edge[e]==edge[e^1])) {
+            byTarget[start[edge[e^1]]++] = e;
+        }
+    }
+    memset(start, 0, (n+2) * sizeof(long));
+    for(long k=0; k<count; k++) {
+        start[edge[byTarget[k]]+1]++;
+    }
+    for(int x=1; x<n+1; x++) {
+        start[x+1] += start[x];
+    }
+    for(long k=0; k<count; k++) {
+        bySource[start[edge[byTarget[k]]]++] = byTarget[k];
+    }
+    graphFree(G, MEMORY_SCRATCH, byTarget);
+
+    // Fill each List with its entries, start[x-1] to start[x] once the
+    // counts above have been used up as positions
+    long most = 0;
+    for(int x=1; x<n+1; x++) {
+        if(start[x]-start[x-1] > most) {
+            most = start[x] - start[x-1];
+        }
+    }
+    int* adj = graphArray(G, MEMORY_SCRATCH, most+1, sizeof(int), ALLOC_DEFAULT);
+    int* cost = graphArray(G, MEMORY_SCRATCH, most+1, sizeof(int), ALLOC_DEFAULT);
+    for(int x=1; x<n+1; x++) {
+        long first = start[x-1];
+        long end = start[x];
+        if(first == end) {
+            continue;
+        }
+
+        // A List that already has neighbors takes its entries one at a time
+        if(length(G->neighbor[x]) > 0) {
+            for(long k=first; k<end; k++) {
+                unsigned int e = bySource[k];
+                int added = insertNeighbor(G, x, edge[e^1], weight!=NULL ? weight[e/2] : 1);
+                if(e%2 == 0) {
+                    G->size += added;
+                    G->dropped += !added;
+                }
+            }
+            markDirty(G, x);
+            continue;
+        }
+
+        // Otherwise append them in one go. Each later duplicate goes in
+        // ahead of the ones before it, as insertNeighbor() would put it,
+        // or is dropped if duplicates are being dropped.
+        int len = 0;
+        for(long k=first; k<end; ) {
+            int v = edge[bySource[k]^1];
+            long run = k;
+            while(run<end && edge[bySource[run]^1]==v) {
+                run++;
+            }
+            for(long j=run-1; j>=k; j--) {
+                unsigned int e = bySource[j];
+                if(G->dedup && j>k) {
+                    G->dropped += (e%2==0);
+                    continue;
+                }
+                adj[len] = v;
+                cost[len] = weight!=NULL ? weight[e/2] : 1;
+                len++;
+                G->size += (e%2==0);
+            }
+            k = run;
+        }
+        appendArray(G->neighbor[x], adj, len);
+        if(G->weighted) {
+            appendArray(G->weight[x], cost, len);
+        }
+        markDirty(G, x);
+    }
+
+    graphFree(G, MEMORY_SCRATCH, adj);
+    graphFree(G, MEMORY_SCRATCH, cost);
+    graphFree(G, MEMORY_SCRATCH, bySource);
+    graphFree(G, MEMORY_SCRATCH, start);
+    checkBudget(G);
+}
+
+// Turns dropping duplicate edges on (if on is true) or off. While it is on,
+// adding a self-loop, or an edge whose endpoints are already joined, leaves
+// G unchanged and adds to the count returned by getDropped(), so getSize()
+// counts distinct edges only. A duplicate keeps the weight of the first copy.
+// Edges added before it was turned on are left as they are.
+void setDedup(Graph G, int on) {
+
+    // Check if this Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling setDedup() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    G->dedup = (on != 0);
+}
+
+// Limits the memory G and its Searches may hold to the given number of
+// bytes, or lifts the limit if bytes is 0. From then on, whatever would
+// take them over the budget (adding edges, building an index, creating
+// a Search or running a search that needs buffers of its own) exits with
+// an error before allocating, rather than running the machine out of
+// memory. Exits with an error at once if they already hold more.
+void setMemoryBudget(Graph G, long bytes) {
+
+    // Check if this Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling setMemoryBudget() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    // Make sure the budget is valid
+    if(bytes < 0) {
+        printf("Graph Error: setMemoryBudget() called on improper budget\n");
+        exit(1);
+    }
+
+    G->budget = bytes;
+    checkBudget(G);
+}
+
+// Replaces the adjacency Lists of G by a compressed copy in which each
+// sorted adjacency List is stored as the gaps between its neighbors, in
+// varint form, usually 1 byte per neighbor rather than a whole List node.
+// BFS() and printGraph() read the compressed form directly. The graph
+// becomes read-only: edges can't be added until makeNull() is called.
+void compressGraph(Graph G) {
+
+    // Check if the Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling compressGraph() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    // Nothing to do if the graph is compressed already
+    if(G->packed != NULL) {
+        return;
+    }
+
+    int n = getOrder(G);
+
+    // Work out how many bytes the gaps (and weights) of every List take up
+    G->packOffset = graphArray(G, MEMORY_ADJACENCY, n+2, sizeof(long), G->policy);
+    G->packOffset[1] = 0;
+    G->maxDegree = 0;
+    for(int i=1; i<n+1; i++) {
+        List Adj = G->neighbor[i];
+        long bytes = 0;
+        int last = 0;
+        for(moveFront(Adj); place(Adj)>=0; moveNext(Adj)) {
+            bytes += varintLength(get(Adj) - last);
+            last = get(Adj);
+        }
+        if(G->weighted) {
+            List W = G->weight[i];
+            for(moveFront(W); place(W)>=0; moveNext(W)) {
+                bytes += varintLength(get(W));
+            }
+        }
+        G->packOffset[i+1] = G->packOffset[i] + bytes;
+        if(length(Adj) > G->maxDegree) {
+            G->maxDegree = length(Adj);
+        }
+    }
+    G->packed = graphArray(G, MEMORY_ADJACENCY, G->packOffset[n+1]+1, 1, G->policy);
+
+    // Encode each adjacency List as gaps from the previous neighbor,
+    // freeing the List as soon as it has been encoded
+    for(int i=1; i<n+1; i++) {
+        List Adj = G->neighbor[i];
+        List W = G->weighted ? G->weight[i] : NULL;
+        unsigned char* p = G->packed + G->packOffset[i];
+        int last = 0;
+        if(W != NULL) {
+            moveFront(W);
+        }
+        for(moveFront(Adj); place(Adj)>=0; moveNext(Adj)) {
+            p = writeVarint(p, get(Adj) - last);
+            last = get(Adj);
+            if(W != NULL) {
+                p = writeVarint(p, get(W));
+                moveNext(W);
+            }
+        }
+        freeList(&G->neighbor[i]);
+        if(W != NULL) {
+            freeList(&G->weight[i]);
+        }
+    }
+    graphFree(G, MEMORY_ADJACENCY, G->weight);
+    G->weight = NULL;
+
+    // The CSR index isn't needed any more
+    graphFree(G, MEMORY_ADJACENCY, G->offset);
+    graphFree(G, MEMORY_ADJACENCY, G->degree);
+    graphFree(G, MEMORY_ADJACENCY, G->target);
+    graphFree(G, MEMORY_ADJACENCY, G->cost);
+    graphFree(G, MEMORY_ADJACENCY, G->dirty);
+    graphFree(G, MEMORY_ADJACENCY, G->dirtyFlag);
+    G->offset = NULL;
+    G->degree = NULL;
+    G->target = NULL;
+    G->cost = NULL;
+    G->dirty = NULL;
+    G->dirtyFlag = NULL;
+    G->dirtyCount = -1;
+    G->indexed = 0;
+}
+
+// Copies the adjacency List of vertex i, and its weights, into the slice
+// of the CSR index starting at offset[i]
+static void copySlice(Graph G, int i) {
+
+    G->degree[i] = toArray(G->neighbor[i], G->target + G->offset[i]);
+    if(G->weighted) {
+        toArray(G->weight[i], G->cost + G->offset[i]);
+    }
+}
+
+// Builds the CSR index of G from its adjacency Lists if an edge has been
+// added or removed since it was last built. BFS reads the index rather than
+// the Lists, so a search never moves a List cursor and many can share one
+// Graph. When only a few vertices have changed and each still fits in its
+// slice, just those slices are copied again. Otherwise the whole index is
+// rebuilt, and if it had been built before, every slice is given an eighth
+// more room than it needs so that later updates can be done in place.
+static void buildIndex(Graph G) {
+
+    pthread_mutex_lock(&G->lock);
+
+    // A compressed graph is searched through its packed adjacency instead
+    if(!G->indexed && G->packed==NULL) {
+
+        int n = getOrder(G);
+        int patched = 0;
+
+        // Try copying just the slices of the vertices that have changed,
+        // unless the graph has become weighted since the index was built
+        if(G->dirtyCount>=0 && (G->cost!=NULL || !G->weighted)) {
+            patched = 1;
+            for(int k=0; k<G->dirtyCount; k++) {
+                int i = G->dirty[k];
+                if(length(G->neighbor[i]) > G->offset[i+1] - G->offset[i]) {
+                    patched = 0;
+                    break;
+                }
+            }
+            if(patched) {
+                for(int k=0; k<G->dirtyCount; k++) {
+                    copySlice(G, G->dirty[k]);
+                }
+            }
+        }
+
+        if(!patched) {
+
+            // Leave room to spare if the graph has changed since the last build
+            int spare = (G->offset != NULL);
+
+            // Count the neighbors of every vertex to find where each one starts
+            graphFree(G, MEMORY_ADJACENCY, G->offset);
+            graphFree(G, MEMORY_ADJACENCY, G->degree);
+            G->offset = graphArray(G, MEMORY_ADJACENCY, n+2, sizeof(long), G->policy);
+            G->degree = graphArray(G, MEMORY_ADJACENCY, n+1, sizeof(int), G->policy);
+            G->offset[1] = 0;
+            for(int i=1; i<n+1; i++) {
+                int len = length(G->neighbor[i]);
+                G->offset[i+1] = G->offset[i] + len + (spare ? len/8 + 1 : 0);
+            }
+
+            // Copy every adjacency List into its slice of the target array,
+            // and its weights into the same slice of the cost array
+            graphFree(G, MEMORY_ADJACENCY, G->target);
+            graphFree(G, MEMORY_ADJACENCY, G->cost);
+            G->target = graphArray(G, MEMORY_ADJACENCY, G->offset[n+1]+1, sizeof(int), G->policy);
+            G->cost = G->weighted ? graphArray(G, MEMORY_ADJACENCY, G->offset[n+1]+1, sizeof(int), G->policy) : NULL;
+            for(int i=1; i<n+1; i++) {
+                copySlice(G, i);
+            }
+
+            // Start tracking the vertices that change from here on
+            if(G->dirty == NULL) {
+                G->dirty = graphArray(G, MEMORY_ADJACENCY, n/8 + 1, sizeof(int), ALLOC_DEFAULT);
+                G->dirtyFlag = graphArray(G, MEMORY_ADJACENCY, n+1, 1, ALLOC_DEFAULT);
+            }
+            for(int i=1; i<n+1; i++) {
+                G->dirtyFlag[i] = 0;
+            }
+        } else {
+            for(int k=0; k<G->dirtyCount; k++) {
+                G->dirtyFlag[G->dirty[k]] = 0;
+            }
+        }
+
+        G->dirtyCount = 0;
+        G->indexed = 1;
+    }
+
+    pthread_mutex_unlock(&G->lock);
+}
+
+// Makes sure the neighbors of every vertex of the Graph of S can be read
+// through adjacency(): builds the CSR index if it is out of date, or gives
+// S room to decode the neighbors of any vertex if the Graph is compressed
+static void prepareNeighbors(Search S) {
+
+    Graph G = S->graph;
+
+    buildIndex(G);
+
+    if(G->packed!=NULL && S->scratchSize<G->maxDegree) {
+        graphFree(G, MEMORY_SCRATCH, S->scratch);
+        graphFree(G, MEMORY_SCRATCH, S->scratchCost);
+        int policy = G->policy & ~ALLOC_INTERLEAVE;
+        S->scratch = graphArray(G, MEMORY_SCRATCH, G->maxDegree, sizeof(int), policy);
+        S->scratchCost = graphArray(G, MEMORY_SCRATCH, G->maxDegree, sizeof(int), policy);
+        S->scratchSize = G->maxDegree;
+    }
+}
+
+// Makes sure G is ready to be searched by S, which gives up any file
+// loaded into it by loadSearch()
+static void prepareSearch(Search S) {
+    releaseSnapshot(S);
+    prepareNeighbors(S);
+    S->counted = 0;
+}
+
+// Points *adj at the neighbors of x in sorted order, and *cost (when the
+// graph is weighted) at the weights of the edges to them, and returns how
+// many there are. The neighbors of a compressed graph are decoded into the
+// scratch buffers of S. prepareNeighbors() must have been called first.
+static inline int adjacency(Search S, int x, const int** adj, const int** cost) {
+
+    Graph G = S->graph;
+
+    // Read the slice of the CSR index
+    if(G->packed == NULL) {
+        *adj = G->target + G->offset[x];
+        *cost = G->weighted ? G->cost + G->offset[x] : NULL;
+        return(G->degree[x]);
+    }
+
+    // Decode the gaps, and the weights following them if there are any
+    const unsigned char* p = G->packed + G->packOffset[x];
+    const unsigned char* e = G->packed + G->packOffset[x+1];
+    unsigned int y = 0;
+    unsigned int gap;
+    int deg = 0;
+    while(p < e) {
+        p = readVarint(p, &gap);
+        y += gap;
+        S->scratch[deg] = y;
+        if(G->weighted) {
+            p = readVarint(p, &gap);
+            S->scratchCost[deg] = gap;
+        }
+        deg++;
+    }
+    *adj = S->scratch;
+    *cost = G->weighted ? S->scratchCost : NULL;
+    return(deg);
+}
+
+// Builds the CSR index of the transpose of the Graph of S, if the Graph is
+// directed and has changed since it was last built, by counting the
+// in-neighbors of every vertex and then placing each arc x->y in the slice
+// of y. Sources are placed in increasing order, so each slice is sorted.
+// prepareNeighbors() must have been called first.
+static void buildReverse(Search S) {
+
+    Graph G = S->graph;
+
+    pthread_mutex_lock(&G->lock);
+
+    if(G->directed && !G->reversed) {
+
+        int n = getOrder(G);
+        const int* adj;
+        const int* cost;
+
+        // Count the in-neighbors of every vertex to find where each one starts
+        graphFree(G, MEMORY_ADJACENCY, G->reverseOffset);
+        G->reverseOffset = graphArray(G, MEMORY_ADJACENCY, n+2, sizeof(long), G->policy);
+        for(int i=0; i<n+2; i++) {
+            G->reverseOffset[i] = 0;
+        }
+        for(int x=1; x<n+1; x++) {
+            int deg = adjacency(S, x, &adj, &cost);
+            for(int j=0; j<deg; j++) {
+                G->reverseOffset[adj[j]+1]++;
+            }
+        }
+        for(int i=1; i<n+1; i++) {
+            G->reverseOffset[i+1] += G->reverseOffset[i];
+        }
+
+        // Place every arc, keeping the next free place of each slice in fill
+        long* fill = graphArray(G, MEMORY_SCRATCH, n+1, sizeof(long), ALLOC_DEFAULT);
+        memcpy(fill, G->reverseOffset, (n+1) * sizeof(long));
+        graphFree(G, MEMORY_ADJACENCY, G->reverseTarget);
+        G->reverseTarget = graphArray(G, MEMORY_ADJACENCY, G->reverseOffset[n+1]+1, sizeof(int), G->policy);
+        for(int x=1; x<n+1; x++) {
+            int deg = adjacency(S, x, &adj, &cost);
+            for(int j=0; j<deg; j++) {
+                G->reverseTarget[fill[adj[j]]++] = x;
+            }
+        }
+        graphFree(G, MEMORY_SCRATCH, fill);
+
+        G->reversed = 1;
+    }
+
+    pthread_mutex_unlock(&G->lock);
+}
+
+// Points *adj at the in-neighbors of x in sorted order, and returns how
+// many there are. An undirected graph is its own transpose, so its
+// neighbors are read as they are. buildReverse() must have been called first.
+static inline int inAdjacency(Search S, int x, const int** adj) {
+
+    Graph G = S->graph;
+    const int* cost;
+
+    if(!G->directed) {
+        return(adjacency(S, x, adj, &cost));
+    }
+    *adj = G->reverseTarget + G->reverseOffset[x];
+    return((int)(G->reverseOffset[x+1] - G->reverseOffset[x]));
+}
+
+// Runs the level-synchronous BFS shared by every entry point. Vertices
+// are stored in the queue array in the order they are discovered, and
+// levelStart marks where each level begins, so the frontier of every level
+// is a slice of the same buffer. Vertices at depth k are discovered but not
+// expanded; a negative k places no limit on the depth. onVertex and onLevel
+// are the callbacks of visitBFS(), or NULL. Every caller passes constants
+// for them, so each gets its own copy of the loop with the tests folded away.
+// If reverse is true the search follows arcs backwards, through the
+// in-neighbors of each vertex. Returns false (0) if a callback stopped
+// the search, otherwise true (1).
+static ALWAYS_INLINE int exploreBFS(Search S, int s, int k, VisitVertex onVertex, VisitLevel onLevel, void* context, int reverse) {
+
+    int n = getOrder(S->graph);
+
+    // Make sure the graph is ready to be read
+    prepareSearch(S);
+    if(reverse) {
+        buildReverse(S);
+    }
+    int* parent = S->parent;
+    int* distance = S->distance;
+
+    // Initialize all parents to NIL and all distances to INF,
+    // which marks every vertex as undiscovered
+    for(int i=1; i<n+1; i++) {
+        parent[i] = NIL;
+        distance[i] = INF;
+    }
+
+    // Set the distance from the source to 0, the parent
+    // of the source to NIL, and the source accordingly
+    distance[s] = 0;
+    parent[s] = NIL;
+    S->source = s;
+
+    // The source alone makes up level 0
+    int* Q = S->queue;
+    int tail = 0;
+    Q[tail++] = s;
+    int stop = (onVertex!=NULL && !onVertex(context, s, NIL, 0));
+
+    // The frontier of level d is the slice Q[start..end)
+    int start = 0;
+    int end = tail;
+    int d = 0;
+
+    // Run the loop while the current frontier isn't empty
+    while(start<end && !stop) {
+
+        S->levelStart[d] = start;
+
+        // Every vertex of this level is known once the last one is expanded
+        if(onLevel!=NULL && !onLevel(context, d, Q+start, end-start)) {
+            stop = 1;
+
+        // Only expand the frontier if it lies above the depth limit
+        } else if(k<0 || d<k) {
+
+            for(int i=start; i<end && !stop; i++) {
+
+                // Get the next vertex of the frontier and its neighbors
+                int x = Q[i];
+                const int* adj;
+                const int* cost;
+                int deg = reverse ? inAdjacency(S, x, &adj) : adjacency(S, x, &adj, &cost);
+
+                // Traverse through the neighbors of the vertex
+                for(int j=0; j<deg; j++) {
+
+                    int y = adj[j];
+
+                    // Check if the vertex is undiscovered
+                    if(distance[y] == INF) {
+                        // Set the distance of the vertex to its parent's distance plus 1
+                        distance[y] = d + 1;
+
+                        // Set the parent of the vertex to the frontier vertex
+                        parent[y] = x;
+
+                        // Add the vertex to the next frontier
+                        Q[tail++] = y;
+
+                        // Hand the vertex to the visitor, which may stop here
+                        if(onVertex!=NULL && !onVertex(context, y, x, d+1)) {
+                            stop = 1;
+                            break;
+                        }
+                    }
+
+                }
+            }
+
+        }
+
+        // The vertices discovered while expanding this level form the next one
+        start = end;
+        end = tail;
+        d++;
+    }
+
+    // A search stopped early may have started on the next level already
+    if(start < end) {
+        S->levelStart[d] = start;
+        d++;
+    }
+
+    // Close off the last level
+    S->levelStart[d] = tail;
+    S->levels = d;
+
+    return(!stop);
+}
+
+// Runs BFS from s on behalf of every entry point without a visitor
+static void runBFS(Search S, int s, int k) {
+    exploreBFS(S, s, k, NULL, NULL, NULL, 0);
+}
+
+// Private RadixHeap type
+// Monotone priority queue of (key, vertex) pairs for Dijkstra's algorithm.
+// Bucket 0 holds the pairs whose key equals the last key popped, and bucket
+// i>0 those whose key first differs from it in bit i-1, so each pair moves
+// down at most 32 times before it is popped. The buckets count as scratch
+// memory held by graph.
+typedef struct RadixHeap {
+    Graph graph;
+    unsigned int* key[33];
+    int* vertex[33];
+    int size[33];
+    int capacity[33];
+    unsigned int last;
+    long count;
+} RadixHeap;
+
+// Adds the pair (key, v) to H. key must not be less than the last key popped.
+static void heapPush(RadixHeap* H, unsigned int key, int v) {
+
+    int b = key==H->last ? 0 : 32 - __builtin_clz(key ^ H->last);
+
+    // Double the bucket when it is full
+    if(H->size[b] == H->capacity[b]) {
+        long more = H->capacity[b]>0 ? H->capacity[b] : 16;
+        reserveMemory(H->graph, MEMORY_SCRATCH, more * (long)(sizeof(unsigned int) + sizeof(int)));
+        H->capacity[b] += more;
+        H->key[b] = realloc(H->key[b], H->capacity[b] * sizeof(unsigned int));
+        H->vertex[b] = realloc(H->vertex[b], H->capacity[b] * sizeof(int));
+        if(H->key[b]==NULL || H->vertex[b]==NULL) {
+            releaseMemory(H->graph, MEMORY_SCRATCH, more * (long)(sizeof(unsigned int) + sizeof(int)));
+            printf("Graph Error: unable to grow the heap of shortestPaths()\n");
+            exit(1);
+        }
+    }
+
+    H->key[b][H->size[b]] = key;
+    H->vertex[b][H->size[b]] = v;
+    H->size[b]++;
+    H->count++;
+}
+
+// Removes a pair with the smallest key from H, which must not be empty,
+// storing its key in *key and returning its vertex
+static int heapPop(RadixHeap* H, unsigned int* key) {
+
+    // Refill bucket 0 from the first non-empty bucket: its smallest key
+    // becomes the last key, and its pairs spread over the lower buckets
+    if(H->size[0] == 0) {
+        int b = 1;
+        while(H->size[b] == 0) {
+            b++;
+        }
+        unsigned int least = H->key[b][0];
+        for(int i=1; i<H->size[b]; i++) {
+            if(H->key[b][i] < least) {
+                least = H->key[b][i];
+            }
+        }
+        H->last = least;
+        int moved = H->size[b];
+        H->size[b] = 0;
+        H->count -= moved;
+        for(int i=0; i<moved; i++) {
+            heapPush(H, H->key[b][i], H->vertex[b][i]);
+        }
+    }
+
+    H->size[0]--;
+    H->count--;
+    *key = H->key[0][H->size[0]];
+    return(H->vertex[0][H->size[0]]);
+}
+
+// Runs Dijkstra's algorithm from s with a radix heap, for any
+// non-negative edge weights
+static void runDijkstra(Search S, int s) {
+
+    RadixHeap H = { S->graph, {NULL}, {NULL}, {0}, {0}, 0, 0 };
+    int* parent = S->parent;
+    int* distance = S->distance;
+
+    heapPush(&H, 0, s);
+
+    while(H.count > 0) {
+
+        unsigned int key;
+        int x = heapPop(&H, &key);
+
+        // Skip pairs left behind when a shorter path was found
+        if(key != (unsigned int)distance[x]) {
+            continue;
+        }
+
+        // Relax every edge leaving x
+        const int* adj;
+        const int* cost;
+        int deg = adjacency(S, x, &adj, &cost);
+        for(int j=0; j<deg; j++) {
+            int y = adj[j];
+            unsigned int through = key + (cost!=NULL ? cost[j] : 1);
+            if(distance[y]==INF || through<(unsigned int)distance[y]) {
+                distance[y] = through;
+                parent[y] = x;
+                heapPush(&H, through, y);
+            }
+        }
+    }
+
+    for(int b=0; b<33; b++) {
+        free(H.key[b]);
+        free(H.vertex[b]);
+        releaseMemory(S->graph, MEMORY_SCRATCH, H.capacity[b] * (long)(sizeof(unsigned int) + sizeof(int)));
+    }
+}
+
+// Runs 0-1 BFS from s, for graphs whose edge weights are all 0 or 1:
+// vertices reached over a 0 edge go to the front of a deque and those
+// reached over a 1 edge to the back, so the deque stays sorted by distance
+static void run01BFS(Search S, int s) {
+
+    int* parent = S->parent;
+    int* distance = S->distance;
+
+    // Circular deque of vertices, doubled whenever it fills up
+    int capacity = getOrder(S->graph) + 1;
+    int* D = graphArray(S->graph, MEMORY_SCRATCH, capacity, sizeof(int), ALLOC_DEFAULT);
+    int head = 0;
+    int count = 0;
+
+    D[0] = s;
+    count = 1;
+
+    while(count > 0) {
+
+        // Pop the front vertex
+        int x = D[head];
+        head = (head + 1) % capacity;
+        count--;
+
+        // Relax every edge leaving x
+        const int* adj;
+        const int* cost;
+        int deg = adjacency(S, x, &adj, &cost);
+        for(int j=0; j<deg; j++) {
+            int y = adj[j];
+            int w = cost!=NULL ? cost[j] : 1;
+            if(distance[y]==INF || distance[x]+w<distance[y]) {
+                distance[y] = distance[x] + w;
+                parent[y] = x;
+
+                // Make room for one more vertex
+                if(count == capacity) {
+                    int* E = graphArray(S->graph, MEMORY_SCRATCH, 2L * capacity, sizeof(int), ALLOC_DEFAULT);
+                    for(int i=0; i<count; i++) {
+                        E[i] = D[(head + i) % capacity];
+                    }
+                    graphFree(S->graph, MEMORY_SCRATCH, D);
+                    D = E;
+                    head = 0;
+                    capacity *= 2;
+                }
+
+                // Push y to the front over a 0 edge, to the back otherwise
+                if(w == 0) {
+                    head = (head + capacity - 1) % capacity;
+                    D[head] = y;
+                } else {
+                    D[(head + count) % capacity] = y;
+                }
+                count++;
+            }
+        }
+    }
+
+    graphFree(S->graph, MEMORY_SCRATCH, D);
+}
+
+
+// Runs the BFS algorithm on the Graph G with source s, 
+// setting the distance, parent, and source fields of G accordingly.
+void BFS(Graph G, int s) {
+
+    // Check if this Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling BFS() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    searchBFS(G->state, s);
+}
+
+// Runs BFS on the Graph G with source s, but stops expanding at depth k, so
+// only the vertices within k hops of s are discovered. All other vertices are
+// left with distance INF and parent NIL. Returns the number of levels reached,
+// whose vertices can be read back with getLevelSize() and getLevel().
+int BFSDepth(Graph G, int s, int k) {
+
+    // Check if this Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling BFSDepth() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    return(searchDepth(G->state, s, k));
+}
+
+// Runs BFS with source s over the Graph of this Search, storing the result in
+// S rather than in the Graph. Searches over the same Graph may run in parallel
+// as long as no edges are added while they do.
+void searchBFS(Search S, int s) {
+
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling searchBFS() on NULL Search reference\n");
+        exit(1);
+    }
+
+    // Checks if s is a valid vertex
+    if(s<1 || s>getOrder(S->graph)) {
+        printf("Graph Error: BFS() called on improper source");
+        exit(1);
+    }
+
+    runBFS(S, s, -1);
+}
+
+// Same as BFSDepth(), but stores the result in the Search S
+int searchDepth(Search S, int s, int k) {
+
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling searchDepth() on NULL Search reference\n");
+        exit(1);
+    }
+
+    // Checks if s is a valid vertex and k is a valid depth
+    if(s<1 || s>getOrder(S->graph) || k<0) {
+        printf("Graph Error: BFSDepth() called on improper source or depth");
+        exit(1);
+    }
+
+    runBFS(S, s, k);
+
+    return(S->levels);
+}
+
+// Runs BFS on the Graph G with source s, to depth k (or without a limit
+// if k is negative), calling onVertex on each vertex as it is discovered and
+// onLevel on each level once all of its vertices are known. Either may be
+// NULL. Returns true (1) if the search ran to the end, otherwise false (0).
+// A search that is stopped keeps what it has found so far: the vertices
+// discovered have their distances and parents, and the levels reached so
+// far, the last of which may be only partly discovered, can be read back.
+int visitBFS(Graph G, int s, int k, VisitVertex onVertex, VisitLevel onLevel, void* context) {
+
+    // Check if this Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling visitBFS() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    return(searchVisit(G->state, s, k, onVertex, onLevel, context));
+}
+
+// Same as visitBFS(), but stores the result in the Search S
+int searchVisit(Search S, int s, int k, VisitVertex onVertex, VisitLevel onLevel, void* context) {
+
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling searchVisit() on NULL Search reference\n");
+        exit(1);
+    }
+
+    // Checks if s is a valid vertex
+    if(s<1 || s>getOrder(S->graph)) {
+        printf("Graph Error: visitBFS() called on improper source");
+        exit(1);
+    }
+
+    return(exploreBFS(S, s, k, onVertex, onLevel, context, 0));
+}
+
+// Visitor for visitBFS() and searchVisit() that stops the search once it
+// finds the vertex its context points to
+int stopAtVertex(void* context, int v, int parent, int d) {
+    (void)parent;
+    (void)d;
+    return(v != *(int*)context);
+}
+
+// Runs BFS on the Graph G from s along arcs followed backwards, so it finds
+// the vertices that can reach s. Afterwards getDist(G, u) is the length of
+// a shortest path from u to s, getParent(G, u) is the vertex after u on such
+// a path, and getPath(G, u) gives that path from s back to u. The transpose
+// of G is built in CSR form the first time it is wanted after G changes.
+// An undirected graph, one with no arcs added or removed on their own, is
+// its own transpose, so this is then the same as BFS().
+void reverseBFS(Graph G, int s) {
+
+    // Check if this Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling reverseBFS() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    searchReverse(G->state, s);
+}
+
+// Same as reverseBFS(), but stores the result in the Search S
+void searchReverse(Search S, int s) {
+
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling searchReverse() on NULL Search reference\n");
+        exit(1);
+    }
+
+    // Checks if s is a valid vertex
+    if(s<1 || s>getOrder(S->graph)) {
+        printf("Graph Error: reverseBFS() called on improper source");
+        exit(1);
+    }
+
+    exploreBFS(S, s, -1, NULL, NULL, NULL, 1);
+}
+
+// Finds a shortest path from s to t in the Graph of S by bidirectional BFS:
+// one search goes forward from s along arcs and another backward from t
+// along the transpose, a whole level at a time, each time on the side with
+// the smaller frontier, until they meet. Appends the path to L, or NIL if
+// there is none, and returns its length, or INF. Often reads far less of
+// the graph than BFS() would, but of several shortest paths it may find a
+// different one. The result of S's last search is left as it was.
+int searchBetween(Search S, int s, int t, List L) {
+
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling searchBetween() on NULL Search reference\n");
+        exit(1);
+    }
+
+    int n = getOrder(S->graph);
+
+    // Checks if s and t are valid vertices
+    if(s<1 || s>n || t<1 || t>n) {
+        printf("Graph Error: searchBetween() called on improper vertex");
+        exit(1);
+    }
+
+    // Make sure both directions can be read
+    prepareNeighbors(S);
+    buildReverse(S);
+
+    // Allocate the arrays of both sides the first time, with every vertex
+    // undiscovered
+    if(S->sideDistance[0] == NULL) {
+        int policy = S->graph->policy & ~ALLOC_INTERLEAVE;
+        for(int side=0; side<2; side++) {
+            S->sideDistance[side] = graphArray(S->graph, MEMORY_SCRATCH, n+1, sizeof(int), policy);
+            S->sideParent[side] = graphArray(S->graph, MEMORY_SCRATCH, n+1, sizeof(int), policy);
+            S->sideQueue[side] = graphArray(S->graph, MEMORY_SCRATCH, n+1, sizeof(int), policy);
+            for(int i=1; i<n+1; i++) {
+                S->sideDistance[side][i] = INF;
+                S->sideParent[side][i] = NIL;
+            }
+        }
+    }
+
+    // Each side starts from its own end, its frontier being the slice
+    // queue[start..end) and tail the end of its queue
+    int start[2] = { 0, 0 };
+    int end[2] = { 1, 1 };
+    int tail[2] = { 1, 1 };
+    S->sideQueue[0][0] = s;
+    S->sideQueue[1][0] = t;
+    S->sideDistance[0][s] = 0;
+    S->sideDistance[1][t] = 0;
+    int best = (s == t) ? 0 : INF;
+    int meet = (s == t) ? s : NIL;
+
+    // Expand a whole level of the side with the smaller frontier at a time.
+    // Once a level meets the other side, the best meeting found in it gives
+    // a shortest path, since any shorter one would have met sooner.
+    while(meet==NIL && start[0]<end[0] && start[1]<end[1]) {
+
+        int side = (end[0]-start[0] <= end[1]-start[1]) ? 0 : 1;
+        int* distance = S->sideDistance[side];
+        int* parent = S->sideParent[side];
+        int* other = S->sideDistance[1-side];
+        int* Q = S->sideQueue[side];
+
+        for(int i=start[side]; i<end[side]; i++) {
+            int x = Q[i];
+            const int* adj;
+            const int* cost;
+            int deg = side==0 ? adjacency(S, x, &adj, &cost) : inAdjacency(S, x, &adj);
+            for(int j=0; j<deg; j++) {
+                int y = adj[j];
+                if(distance[y] == INF) {
+                    distance[y] = distance[x] + 1;
+                    parent[y] = x;
+                    Q[tail[side]++] = y;
+                    if(other[y]!=INF && (best==INF || distance[y]+other[y]<best)) {
+                        best = distance[y] + other[y];
+                        meet = y;
+                    }
+                }
+            }
+        }
+        start[side] = end[side];
+        end[side] = tail[side];
+    }
+
+    // Join the path from s to the meeting vertex with the one from there to t
+    if(meet == NIL) {
+        append(L, NIL);
+    } else {
+        int* path = graphArray(S->graph, MEMORY_SCRATCH, best+1, sizeof(int), ALLOC_DEFAULT);
+        int i = S->sideDistance[0][meet];
+        for(int x=meet; i>=0; i--, x=S->sideParent[0][x]) {
+            path[i] = x;
+        }
+        i = S->sideDistance[0][meet];
+        for(int x=meet; x!=t; ) {
+            x = S->sideParent[1][x];
+            path[++i] = x;
+        }
+        appendArray(L, path, best+1);
+        graphFree(S->graph, MEMORY_SCRATCH, path);
+    }
+
+    // Mark every vertex either side reached as undiscovered again
+    for(int side=0; side<2; side++) {
+        for(int i=0; i<tail[side]; i++) {
+            S->sideDistance[side][S->sideQueue[side][i]] = INF;
+            S->sideParent[side][S->sideQueue[side][i]] = NIL;
+        }
+    }
+
+    return(best);
+}
+
+// Finds the shortest paths from s by edge weight, storing them in S
+static void runWeighted(Search S, int s) {
+
+    Graph G = S->graph;
+    int n = getOrder(G);
+
+    // Unweighted graphs are searched faster by BFS
+    if(!G->weighted) {
+        runBFS(S, s, -1);
+        return;
+    }
+
+    // Make sure the graph is ready to be read
+    prepareSearch(S);
+
+    // Initialize all parents to NIL and all distances to INF
+    for(int i=1; i<n+1; i++) {
+        S->parent[i] = NIL;
+        S->distance[i] = INF;
+    }
+    S->distance[s] = 0;
+    S->source = s;
+
+    // Levels are only recorded by BFS
+    S->levels = 0;
+
+    if(G->maxWeight <= 1) {
+        run01BFS(S, s);
+    } else {
+        runDijkstra(S, s);
+    }
+}
+
+// Finds the shortest paths in G from source s, where the length of a path
+// is the sum of the weights of its edges, setting the distance, parent, and
+// source fields of G so that getDist() and getPath() work as after BFS().
+// Uses 0-1 BFS if every weight is 0 or 1, and Dijkstra's algorithm with a
+// radix heap otherwise. The distances must fit in an int.
+void shortestPaths(Graph G, int s) {
+
+    // Check if this Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling shortestPaths() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    searchWeighted(G->state, s);
+}
+
+// Same as shortestPaths(), but stores the result in the Search S
+void searchWeighted(Search S, int s) {
 
-                    // Add the vertex to the List
-                    append(Q, y);
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling searchWeighted() on NULL Search reference\n");
+        exit(1);
+    }
+
+    // Checks if s is a valid vertex
+    if(s<1 || s>getOrder(S->graph)) {
+        printf("Graph Error: shortestPaths() called on improper source");
+        exit(1);
+    }
+
+    runWeighted(S, s);
+}
+
+// Adds b to a, saturating at ULLONG_MAX rather than wrapping around
+static unsigned long long addCounts(unsigned long long a, unsigned long long b) {
+    return(a+b < a ? ULLONG_MAX : a+b);
+}
+
+// Runs BFS from s, then counts the shortest paths to every vertex and
+// records the shortest-path DAG, going out from the source level by level
+static void runCount(Search S, int s) {
+
+    Graph G = S->graph;
+    int n = getOrder(G);
+    int* distance = S->distance;
+
+    runBFS(S, s, -1);
+
+    // Allocate the counts the first time they are wanted
+    int policy = G->policy & ~ALLOC_INTERLEAVE;
+    if(S->paths == NULL) {
+        S->paths = graphArray(G, MEMORY_SCRATCH, n+1, sizeof(unsigned long long), policy);
+        S->predStart = graphArray(G, MEMORY_SCRATCH, n+2, sizeof(long), policy);
+    }
+    unsigned long long* paths = S->paths;
+    long* predStart = S->predStart;
+    for(int i=0; i<n+2; i++) {
+        predStart[i] = 0;
+    }
+    for(int i=1; i<n+1; i++) {
+        paths[i] = 0;
+    }
+    paths[s] = 1;
+
+    // Each vertex passes its count on to the neighbors one level further
+    // out, each of which counts it as a predecessor in predStart[w+1]
+    for(int d=0; d+1<S->levels; d++) {
+        for(int i=S->levelStart[d]; i<S->levelStart[d+1]; i++) {
+            int v = S->queue[i];
+            const int* adj;
+            const int* cost;
+            int deg = adjacency(S, v, &adj, &cost);
+            for(int j=0; j<deg; j++) {
+                if(distance[adj[j]] == d+1) {
+                    paths[adj[j]] = addCounts(paths[adj[j]], paths[v]);
+                    predStart[adj[j]+1]++;
                 }
+            }
+        }
+    }
+
+    // Turn the numbers of predecessors into the start of each list
+    for(int v=1; v<n+1; v++) {
+        predStart[v+1] += predStart[v];
+    }
+    if(predStart[n+1] > S->predSize) {
+        graphFree(G, MEMORY_SCRATCH, S->pred);
+        S->pred = graphArray(G, MEMORY_SCRATCH, predStart[n+1], sizeof(int), policy);
+        S->predSize = predStart[n+1];
+    }
 
+    // Fill in the lists, moving each start along as its list fills up,
+    // then move the starts back
+    for(int d=0; d+1<S->levels; d++) {
+        for(int i=S->levelStart[d]; i<S->levelStart[d+1]; i++) {
+            int v = S->queue[i];
+            const int* adj;
+            const int* cost;
+            int deg = adjacency(S, v, &adj, &cost);
+            for(int j=0; j<deg; j++) {
+                if(distance[adj[j]] == d+1) {
+                    S->pred[predStart[adj[j]]++] = v;
+                }
             }
+        }
+    }
+    for(int v=n; v>=1; v--) {
+        predStart[v+1] = predStart[v];
+    }
+    predStart[1] = 0;
+
+    S->counted = 1;
+}
+
+// Runs BFS on the Graph G with source s, as BFS() does, and also counts the
+// shortest paths from s to every vertex and records the shortest-path DAG,
+// so that getPathCount() and the PathIterator functions can be used. Path
+// lengths count edges, and parallel edges make for different paths.
+void countBFS(Graph G, int s) {
+
+    // Check if this Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling countBFS() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    searchCount(G->state, s);
+}
+
+// Same as countBFS(), but stores the result in the Search S
+void searchCount(Search S, int s) {
+
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling searchCount() on NULL Search reference\n");
+        exit(1);
+    }
+
+    // Checks if s is a valid vertex
+    if(s<1 || s>getOrder(S->graph)) {
+        printf("Graph Error: countBFS() called on improper source");
+        exit(1);
+    }
+
+    runCount(S, s);
+}
+
+// Returns the number of shortest paths from the source of the most recent
+// call to countBFS() to u, or ULLONG_MAX if there are at least that many
+unsigned long long getPathCount(Graph G, int u) {
+
+    // Check if this Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling getPathCount() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    return(searchPathCount(G->state, u));
+}
+
+// Same as getPathCount(), but for the most recent searchCount() on S
+unsigned long long searchPathCount(Search S, int u) {
+
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling searchPathCount() on NULL Search reference\n");
+        exit(1);
+    }
+
+    // Check that the paths were counted and u is a valid vertex
+    if(!S->counted || u<1 || u>getOrder(S->graph)) {
+        printf("Graph Error: getPathCount() called on improper Graph");
+        exit(1);
+    }
+
+    return(S->paths[u]);
+}
+
+// Returns a new PathIterator over the shortest paths from the source of the
+// most recent searchCount() on S to u. It reads the shortest-path DAG of S,
+// and must not be used once S has run again.
+PathIterator newPathIterator(Search S, int u) {
+
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling newPathIterator() on NULL Search reference\n");
+        exit(1);
+    }
+
+    // Check that the paths were counted and u is a valid vertex
+    if(!S->counted || u<1 || u>getOrder(S->graph)) {
+        printf("Graph Error: newPathIterator() called on improper Search");
+        exit(1);
+    }
+
+    // Allocate memory for the iterator, which counts as scratch
+    PathIterator I = graphObject(S->graph, MEMORY_SCRATCH, sizeof(PathIteratorObj));
+
+    // Every path has as many edges as the distance to u, if it is reachable
+    I->search = S;
+    I->target = u;
+    I->length = S->distance[u];
+    I->first = 1;
+    I->at = graphArray(S->graph, MEMORY_SCRATCH, I->length+2, sizeof(int), ALLOC_DEFAULT);
+    I->choice = graphArray(S->graph, MEMORY_SCRATCH, I->length+2, sizeof(int), ALLOC_DEFAULT);
+    I->at[0] = u;
+
+    return(I);
+}
+
+// Frees all dynamic memory associated with the PathIterator
+// *pI, then sets the handle *pI to NULL.
+void freePathIterator(PathIterator* pI) {
+
+    // Checks if pI or its pointer is NULL
+    if(pI!=NULL && *pI!=NULL) {
+        Graph G = (*pI)->search->graph;
+        graphFree(G, MEMORY_SCRATCH, (*pI)->at);
+        graphFree(G, MEMORY_SCRATCH, (*pI)->choice);
+        releaseMemory(G, MEMORY_SCRATCH, (long)sizeof(PathIteratorObj));
+        free(*pI);
+        *pI = NULL;
+    }
+
+}
+
+// Appends to the List L the vertices of the next shortest path of I, from
+// the source to the target, and returns true (1), or returns false (0) and
+// leaves L alone if every path has been returned. Only one path is held at
+// a time, so the paths can be walked through however many there are.
+int nextPath(PathIterator I, List L) {
+
+    // Check if this PathIterator is NULL
+    if(I == NULL) {
+        printf("Graph Error: calling nextPath() on NULL PathIterator reference\n");
+        exit(1);
+    }
+
+    Search S = I->search;
+    int i;
+
+    // There is nothing left once the last path has been returned
+    if(I->length < 0) {
+        return 0;
+    }
 
+    if(I->first) {
+        // Take the first predecessor all the way back to the source
+        I->first = 0;
+        i = 0;
+    } else {
+        // Advance the choice nearest the source that has a predecessor left
+        for(i=I->length-1; i>=0; i--) {
+            int v = I->at[i];
+            if(I->choice[i]+1 < S->predStart[v+1]-S->predStart[v]) {
+                break;
+            }
         }
+        if(i < 0) {
+            I->length = -1;
+            return 0;
+        }
+        I->choice[i]++;
+        I->at[i+1] = S->pred[S->predStart[I->at[i]] + I->choice[i]];
+        i++;
+    }
+
+    // Take the first predecessor from there on back to the source
+    for(; i<I->length; i++) {
+        I->choice[i] = 0;
+        I->at[i+1] = S->pred[S->predStart[I->at[i]]];
+    }
+
+    // Append the path, starting from the source
+    for(i=I->length; i>=0; i--) {
+        append(L, I->at[i]);
+    }
+
+    return 1;
+}
+
+// Points *adj at the neighbors of u in the Graph of S, in sorted order, and
+// returns how many there are. The array is only valid until the next call
+// on S, since the neighbors of a compressed graph are decoded into a buffer
+// of S, and until the Graph changes. Searches over the same Graph may call
+// this in parallel, as they may run BFS.
+int searchNeighbors(Search S, int u, const int** adj) {
+
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling searchNeighbors() on NULL Search reference\n");
+        exit(1);
+    }
+
+    // Check if u is a valid vertex
+    Graph G = S->graph;
+    if(u<1 || u>getOrder(G)) {
+        printf("Graph Error: searchNeighbors() called on improper vertex");
+        exit(1);
+    }
+
+    // Only take the lock on the index when it might be out of date
+    if((G->packed==NULL && !G->indexed) || (G->packed!=NULL && S->scratchSize<G->maxDegree)) {
+        prepareNeighbors(S);
+    }
+
+    const int* cost;
+    return(adjacency(S, u, adj, &cost));
+}
+
+// Points *adj at the in-neighbors of u in the Graph of S, the vertices with
+// an arc to u, in sorted order, and returns how many there are. For an
+// undirected graph these are just its neighbors. The transpose is built
+// the first time it is wanted after the Graph changes; otherwise the same
+// rules apply as for searchNeighbors().
+int searchInNeighbors(Search S, int u, const int** adj) {
+
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling searchInNeighbors() on NULL Search reference\n");
+        exit(1);
+    }
 
-        // Change the color of the front vertex in the List to black,
-        // since all of its neighbors have been discovered.
-        G->color[x] = 2;
+    // Check if u is a valid vertex
+    Graph G = S->graph;
+    if(u<1 || u>getOrder(G)) {
+        printf("Graph Error: searchInNeighbors() called on improper vertex");
+        exit(1);
+    }
 
+    // Only take the lock on the indexes when they might be out of date
+    if((G->packed==NULL && !G->indexed) || (G->packed!=NULL && S->scratchSize<G->maxDegree)) {
+        prepareNeighbors(S);
+    }
+    if(G->directed && !G->reversed) {
+        buildReverse(S);
     }
 
-    // Free the List
-    freeList(&Q);
+    return(inAdjacency(S, u, adj));
 }
 
 // Other operations -----------------------------------------------------------
 
-// Prints the adjacency list representation of G to the file pointed to by out
+// Prints the adjacency list representation of G to the file pointed to by out.
+// In a weighted graph each neighbor is followed by the edge weight in parentheses.
 void printGraph(FILE* out, Graph G) {
 
     // Check if the Graph is NULL
     if(G == NULL) {
-        printf("Graph Error: calling addArc() on NULL Graph reference\n");
+        printf("Graph Error: calling printGraph() on NULL Graph reference\n");
         exit(1);
     }
 
     int n = getOrder(G);
 
-    // Prints out each vertex in the Graph along with its adjacency list
+    // Prints out each vertex in the Graph along with its adjacency list,
+    // giving the weight of each edge in parentheses if the graph is weighted
     for(int i=1; i<n+1; i++) {
         fprintf(out, "%d: ", i);
-        printList(out, G->neighbor[i]);
+        if(G->packed != NULL) {
+            // Decode the compressed adjacency list as it is printed
+            const unsigned char* p = G->packed + G->packOffset[i];
+            const unsigned char* e = G->packed + G->packOffset[i+1];
+            unsigned int y = 0;
+            unsigned int gap;
+            while(p < e) {
+                p = readVarint(p, &gap);
+                y += gap;
+                fprintf(out, "%u", y);
+                if(G->weighted) {
+                    p = readVarint(p, &gap);
+                    fprintf(out, "(%u)", gap);
+                }
+                if(p < e) {
+                    fprintf(out, " ");
+                }
+            }
+        } else if(G->weighted) {
+            List Adj = G->neighbor[i];
+            List W = G->weight[i];
+            for(moveFront(Adj), moveFront(W); place(Adj)>=0; moveNext(Adj), moveNext(W)) {
+                fprintf(out, place(Adj)>0 ? " %d(%d)" : "%d(%d)", get(Adj), get(W));
+            }
+        } else {
+            printList(out, G->neighbor[i]);
+        }
         fprintf(out, "\n");
     }
 
 }
 
+// Prints to out where the pages of each array of G and of its own Search
+// live, as reported by printArrayPlacement() in Memory.h
+void printPlacement(FILE* out, Graph G) {
+
+    // Check if the Graph is NULL
+    if(G == NULL) {
+        printf("Graph Error: calling printPlacement() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    printArrayPlacement(out, "neighbor", G->neighbor);
+    if(G->packed != NULL) {
+        printArrayPlacement(out, "packed", G->packed);
+        printArrayPlacement(out, "packOffset", G->packOffset);
+    } else {
+        printArrayPlacement(out, "offset", G->offset);
+        printArrayPlacement(out, "target", G->target);
+    }
+    if(G->state->snapshot != NULL) {
+        fprintf(out, "search: mapped from a snapshot file\n");
+    } else {
+        printArrayPlacement(out, "parent", G->state->parent);
+        printArrayPlacement(out, "distance", G->state->distance);
+        printArrayPlacement(out, "queue", G->state->queue);
+    }
+}
+
+// Returns the checksum of the adjacency of the Graph of S (see GraphObj),
+// working it out again first if the graph has changed since it last was
+static unsigned long long graphChecksum(Search S) {
+
+    Graph G = S->graph;
+    int n = getOrder(G);
+
+    prepareNeighbors(S);
+    pthread_mutex_lock(&G->lock);
+
+    if(!G->summed) {
+        unsigned long long h = 14695981039346656037ULL;
+        h = (h ^ (unsigned int)G->weighted) * 1099511628211ULL;
+        for(int x=1; x<n+1; x++) {
+            const int* adj;
+            const int* cost;
+            int deg = adjacency(S, x, &adj, &cost);
+            h = (h ^ (unsigned int)deg) * 1099511628211ULL;
+            for(int i=0; i<deg; i++) {
+                h = (h ^ (unsigned int)adj[i]) * 1099511628211ULL;
+                if(cost != NULL) {
+                    h = (h ^ (unsigned int)cost[i]) * 1099511628211ULL;
+                }
+            }
+        }
+        G->checksum = h;
+        G->summed = 1;
+    }
+
+    unsigned long long checksum = G->checksum;
+    pthread_mutex_unlock(&G->lock);
+    return(checksum);
+}
+
+// Writes the result of the most recent run of S (its source, parents,
+// distances and levels) to the file at path in a compact binary form that
+// loadSearch() maps back in. The file is written under a temporary name no
+// other process can be using, and then renamed, so that readers never see
+// half of it. Returns true (1) if the file was written, otherwise false (0).
+int saveSearch(Search S, char* path) {
+
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling saveSearch() on NULL Search reference\n");
+        exit(1);
+    }
+
+    // Check that there is a result to save
+    if(S->source == NIL) {
+        printf("Graph Error: calling saveSearch() on Search that has not run\n");
+        exit(1);
+    }
+
+    int n = getOrder(S->graph);
+    SnapshotHeader H;
+    memset(&H, 0, sizeof(H));
+    memcpy(H.magic, SNAPSHOT_MAGIC, sizeof(H.magic));
+    H.order = n;
+    H.size = getSize(S->graph);
+    H.source = S->source;
+    H.levels = S->levels;
+    H.reached = S->levels>0 ? S->levelStart[S->levels] : 0;
+    H.checksum = graphChecksum(S);
+
+    // Write everything to the temporary file, readable by all like the
+    // file it stands in for
+    char* temp = malloc(strlen(path) + 8);
+    sprintf(temp, "%s.XXXXXX", path);
+    int fd = mkstemp(temp);
+    FILE* out = fd>=0 ? fdopen(fd, "wb") : NULL;
+    if(out == NULL) {
+        if(fd >= 0) {
+            close(fd);
+            remove(temp);
+        }
+        free(temp);
+        return 0;
+    }
+    fchmod(fd, 0644);
+    int ok = fwrite(&H, sizeof(H), 1, out) == 1
+          && fwrite(S->parent, sizeof(int), n+1, out) == (size_t)(n+1)
+          && fwrite(S->distance, sizeof(int), n+1, out) == (size_t)(n+1)
+          && fwrite(S->levelStart, sizeof(int), H.levels+1, out) == (size_t)(H.levels+1)
+          && fwrite(S->queue, sizeof(int), H.reached, out) == (size_t)H.reached;
+    ok = (fclose(out) == 0) && ok;
+
+    // Put it in place, or throw it away if anything went wrong
+    if(ok) {
+        ok = (rename(temp, path) == 0);
+    }
+    if(!ok) {
+        remove(temp);
+    }
+    free(temp);
+
+    return ok;
+}
+
+// Maps the file at path, written by saveSearch(), into S so that its source,
+// parents, distances and levels can be read through the search functions
+// without running BFS again. Nothing is copied: the arrays of S point into
+// the mapping until S runs again or is freed. Returns true (1) if the file
+// was loaded, or false (0), leaving S as it was, if it can't be read, holds
+// a vertex out of range, or wasn't saved from a graph with the same edges
+// (and weights) as that of S.
+int loadSearch(Search S, char* path) {
+
+    // Check if this Search is NULL
+    if(S == NULL) {
+        printf("Graph Error: calling loadSearch() on NULL Search reference\n");
+        exit(1);
+    }
+
+    size_t bytes;
+    const char* base = mapFile(path, &bytes);
+    if(base == NULL) {
+        return 0;
+    }
+
+    // Check the header against the Graph, and the length against the header
+    const SnapshotHeader* H = (const SnapshotHeader*)base;
+    int n = getOrder(S->graph);
+    if(bytes < sizeof(SnapshotHeader)
+       || memcmp(H->magic, SNAPSHOT_MAGIC, sizeof(H->magic)) != 0
+       || H->order != n || H->size != getSize(S->graph)
+       || H->source<1 || H->source>n || H->levels<0 || H->levels>n
+       || H->reached<0 || H->reached>n
+       || bytes != sizeof(SnapshotHeader) + sizeof(int)*(2*(size_t)(n+1) + H->levels+1 + H->reached)
+       || H->checksum != graphChecksum(S)) {
+        unmapFile(base, bytes);
+        return 0;
+    }
+
+    // Check that the parents and the queue only hold vertices of the
+    // Graph, and that the levels split the queue, so nothing read through
+    // them can land outside the arrays
+    int* A = (int*)(base + sizeof(SnapshotHeader));
+    const int* levelStart = A + 2*(n+1);
+    const int* queue = levelStart + H->levels+1;
+    int valid = (levelStart[0] == 0 && levelStart[H->levels] == H->reached);
+    for(int i=1; valid && i<n+1; i++) {
+        valid = (A[i]==NIL || (A[i]>=1 && A[i]<=n));
+    }
+    for(int d=0; valid && d<H->levels; d++) {
+        valid = (levelStart[d] <= levelStart[d+1]);
+    }
+    for(int k=0; valid && k<H->reached; k++) {
+        valid = (queue[k]>=1 && queue[k]<=n);
+    }
+    if(!valid) {
+        unmapFile(base, bytes);
+        return 0;
+    }
+
+    // Keep the Search's own arrays aside, unless a file is already loaded
+    if(S->snapshot != NULL) {
+        unmapFile(S->snapshot, S->snapshotBytes);
+    } else {
+        S->kept[0] = S->parent;
+        S->kept[1] = S->distance;
+        S->kept[2] = S->queue;
+        S->kept[3] = S->levelStart;
+    }
+
+    // Point the arrays of S into the mapping
+    S->parent = A;
+    S->distance = A + (n+1);
+    S->levelStart = A + 2*(n+1);
+    S->queue = S->levelStart + H->levels+1;
+    S->source = H->source;
+    S->levels = H->levels;
+    S->snapshot = base;
+    S->snapshotBytes = bytes;
+    S->counted = 0;
+
+    return 1;
+}
@@ -1,4 +1,5 @@
 #include "List.h"
+#include "Memory.h"
 #ifndef _GRAPH_H_INCLUDE_
 #define _GRAPH_H_INCLUDE_
 #include <stdio.h>
@@ -7,19 +8,69 @@
 #define INF -1
 #define NIL 0
 
+// Kinds of memory counted by getMemory()
+#define MEMORY_ADJACENCY 0
+#define MEMORY_VERTEX 1
+#define MEMORY_SCRATCH 2
+#define MEMORY_KINDS 3
+
 // Exported type --------------------------------------------------------------
 typedef struct GraphObj* Graph;
 
+// Holds the result of one BFS (source, parents, distances and levels) apart
+// from the Graph, so that many threads can search one Graph at once, each
+// with its own Search. BFS() and the get functions below use a Search that
+// belongs to the Graph itself.
+typedef struct SearchObj* Search;
+
+// Walks through the shortest paths to one vertex recorded by searchCount(),
+// one path at a time
+typedef struct PathIteratorObj* PathIterator;
+
+// Callbacks for visitBFS(), which pass on the context pointer given to it.
+// Each returns true (1) for the search to carry on, or false (0) to stop it.
+// VisitVertex is called on each vertex v as it is discovered, along with its
+// parent and its distance d from the source; the source comes first, with
+// parent NIL. VisitLevel is called on level d, the size vertices at distance
+// d from the source in the order they were discovered, once all of them are
+// known and before any is expanded.
+typedef int (*VisitVertex)(void* context, int v, int parent, int d);
+typedef int (*VisitLevel)(void* context, int d, const int* level, int size);
+
 // Constructors-Destructors ---------------------------------------------------
 
 // Returns a Graph pointing to a newly created GraphObj 
 // representing a graph having n vertices and no edges.
 Graph newGraph(int n);
 
+// Same as newGraph(), but allocates the arrays of the graph and of
+// its Searches with the given policy, which is any combination of
+// the ALLOC_ flags in Memory.h. Searches are never interleaved, since
+// each one is meant to be used by a single thread.
+Graph newGraphPolicy(int n, int policy);
+
 // Frees all dynamic memory associated with the Graph 
 // *pG,then sets thehandle *pG to NULL.
 void freeGraph(Graph* pG);
 
+// Returns a new Search over the Graph G, with no BFS run yet
+Search newSearch(Graph G);
+
+// Frees all dynamic memory associated with the Search
+// *pS, then sets the handle *pS to NULL.
+void freeSearch(Search* pS);
+
+// Returns a new array of n zeroed elements of the given size, counted as
+// memory of the given kind held by G, for the modules that keep state of
+// their own about G, so that it falls under the memory budget of G as well.
+// Exits with an error if there isn't enough memory for it, or it would take
+// G over its memory budget.
+void* newGraphArray(Graph G, int kind, long n, size_t size);
+
+// Frees an array returned by newGraphArray() for G and the same kind.
+// Does nothing if A is NULL.
+void freeGraphArray(Graph G, int kind, void* A);
+
 // Access functions -----------------------------------------------------------
 
 // Returns the number of vertices in this graph
@@ -28,6 +79,40 @@ int getOrder(Graph G);
 // Returns the number of edges in this graph
 int getSize(Graph G);
 
+// Returns true (1) if compressGraph() has been called on this
+// graph since it was created or last made null, otherwise false (0)
+int isCompressed(Graph G);
+
+// Returns true (1) if a weighted edge has been added to this graph since
+// it was created or last made null, otherwise false (0)
+int isWeighted(Graph G);
+
+// Returns true (1) if an arc has been added or removed on its own, without
+// its reverse, since this graph was created or last made null, so that its
+// adjacency lists may not be symmetric, otherwise false (0)
+int isDirected(Graph G);
+
+// Returns the number of duplicate edges and self-loops dropped since the
+// graph was created or last made null, while setDedup() was in effect
+int getDropped(Graph G);
+
+// Returns the number of bytes of the given kind of memory held by G and
+// its Searches: MEMORY_ADJACENCY for the graph itself, its adjacency Lists,
+// CSR indexes and compressed adjacency, MEMORY_VERTEX for the arrays every
+// Search keeps per vertex (parents, distances, queue and levels), and
+// MEMORY_SCRATCH for buffers that only some kinds of search use, or that
+// only last for one call. MEMORY_KINDS gives all three together.
+long getMemory(Graph G, int kind);
+
+// Returns the most bytes G and its Searches have held at any one time
+long getMemoryPeak(Graph G);
+
+// Returns about how many bytes the CSR index of G takes up, or will take
+// up once it is built for the edges G has now. Searching needs the index
+// on top of the adjacency Lists, unless the graph is compressed, when it
+// is 0.
+long getIndexBytes(Graph G);
+
 // Returns the source vertex most recently used in function 
 // BFS(), or NIL if BFS() has not yet been called.
 int getSource(Graph G);
@@ -45,6 +130,63 @@ int getDist(Graph G, int u);
 // Note: BFS() must be called before getPath() because there needs to be a source vertex
 void getPath(List L, Graph G, int u);
 
+// Returns the number of levels reached by the most recent call to BFS()
+// or BFSDepth(), or 0 if neither has been called yet.
+int getLevels(Graph G);
+
+// Returns the number of vertices at distance d from the most recent BFS source
+int getLevelSize(Graph G, int d);
+
+// Returns the vertices at distance d from the most recent BFS source, in the
+// order BFS discovered them. The array belongs to G and is only valid until
+// the next call to BFS(), BFSDepth() or makeNull().
+const int* getLevel(Graph G, int d);
+
+// Returns the Search that holds the result of BFS() on G
+Search getSearch(Graph G);
+
+// Returns the source vertex most recently used by this Search,
+// or NIL if it has not run yet.
+int searchSource(Search S);
+
+// Returns the parent of vertex u in the Breadth-First tree
+// of this Search, or NIL if it has not run yet.
+int searchParent(Search S, int u);
+
+// Returns the distance from the source of this Search to
+// vertex u, or INF if it has not run yet.
+int searchDist(Search S, int u);
+
+// Appends to the List L the vertices of a shortest path from the source
+// of this Search to u, or appends to L the value NIL if no such path exists.
+void searchPath(List L, Search S, int u);
+
+// Returns the number of levels reached by the most recent
+// BFS of this Search, or 0 if it has not run yet.
+int searchLevels(Search S);
+
+// Returns the number of vertices at distance d from the source of this Search
+int searchLevelSize(Search S, int d);
+
+// Returns the vertices at distance d from the source of this Search, in the
+// order they were discovered. The array belongs to S and is only valid
+// until S runs again.
+const int* searchLevel(Search S, int d);
+
+// Points *adj at the neighbors of u in the Graph of S, in sorted order, and
+// returns how many there are. The array is only valid until the next call
+// on S, since the neighbors of a compressed graph are decoded into a buffer
+// of S, and until the Graph changes. Searches over the same Graph may call
+// this in parallel, as they may run BFS.
+int searchNeighbors(Search S, int u, const int** adj);
+
+// Points *adj at the in-neighbors of u in the Graph of S, the vertices with
+// an arc to u, in sorted order, and returns how many there are. For an
+// undirected graph these are just its neighbors. The transpose is built
+// the first time it is wanted after the Graph changes; otherwise the same
+// rules apply as for searchNeighbors().
+int searchInNeighbors(Search S, int u, const int** adj);
+
 // Manipulation procedures ----------------------------------------------------
 
 // Deletes all edges of G, restoring it to its original (no edge) state
@@ -59,14 +201,187 @@ void addEdge(Graph G, int u, int v);
 // adjacency List of u (but not u to the adjacency List of v)
 void addArc(Graph G, int u, int v);
 
+// Same as addEdge(), but the edge has weight w, which must not be negative.
+// Edges added by addEdge() have weight 1.
+void addWeightedEdge(Graph G, int u, int v, int w);
+
+// Same as addArc(), but the arc has weight w, which must not be negative.
+// Arcs added by addArc() have weight 1.
+void addWeightedArc(Graph G, int u, int v, int w);
+
+// Removes one edge joining u to v, i.e. u is removed from the adjacency
+// List of v, and v from the adjacency List of u. Returns true (1) if there
+// was such an edge, otherwise false (0).
+int removeEdge(Graph G, int u, int v);
+
+// Removes one directed edge from u to v, i.e. v is removed from the
+// adjacency List of u. Returns true (1) if there was such an edge,
+// otherwise false (0).
+int removeArc(Graph G, int u, int v);
+
+// Applies a batch of edge changes to G. add and remove hold pairs of
+// vertices u v, one pair per edge, and either may be NULL. weights, if
+// not NULL, holds the weight of each edge added, which is 1 otherwise.
+// Edges in remove are taken away before those in add are put in, and a
+// removal with no matching edge is ignored. Each changed adjacency List is
+// merged with its changes in one pass, and only the changed vertices of
+// the CSR index are updated, so a small batch costs far less than a rebuild.
+void updateEdges(Graph G, List add, List weights, List remove);
+
+// Same as updateEdges(), but for directed edges from u to v
+void updateArcs(Graph G, List add, List weights, List remove);
+
+// Adds the m edges joining edge[2i] to edge[2i+1], with weights weight[i]
+// if weight isn't NULL, leaving the graph just as adding them one at a time
+// with addEdge() or addWeightedEdge(), in order, would. The edges are sorted
+// into place all at once by two counting sorts, so filling an empty graph
+// this way takes time linear in its size rather than in the sum of the
+// squares of its degrees.
+void addEdges(Graph G, const int* edge, const int* weight, long m);
+
+// Turns dropping duplicate edges on (if on is true) or off. While it is on,
+// adding a self-loop, or an edge whose endpoints are already joined, leaves
+// G unchanged and adds to the count returned by getDropped(), so getSize()
+// counts distinct edges only. A duplicate keeps the weight of the first copy.
+// Edges added before it was turned on are left as they are.
+void setDedup(Graph G, int on);
+
+// Limits the memory G and its Searches may hold to the given number of
+// bytes, or lifts the limit if bytes is 0. From then on, whatever would
+// take them over the budget (adding edges, building an index, creating
+// a Search or running a search that needs buffers of its own) exits with
+// an error before allocating, rather than running the machine out of
+// memory. Exits with an error at once if they already hold more.
+void setMemoryBudget(Graph G, long bytes);
+
+// Replaces the adjacency Lists of G by a compressed copy in which each
+// sorted adjacency List is stored as the gaps between its neighbors, in
+// varint form, usually 1 byte per neighbor rather than a whole List node.
+// BFS() and printGraph() read the compressed form directly. The graph
+// becomes read-only: edges can't be added until makeNull() is called.
+void compressGraph(Graph G);
+
 // Runs the BFS algorithm on the Graph G with source s, 
-// setting the color, distance, parent, and source fields of G accordingly
+// setting the distance, parent, and source fields of G accordingly
 void BFS(Graph G, int s);
 
+// Runs BFS on the Graph G with source s, but stops expanding at depth k, so
+// only the vertices within k hops of s are discovered. All other vertices are
+// left with distance INF and parent NIL. Returns the number of levels reached,
+// whose vertices can be read back with getLevelSize() and getLevel().
+int BFSDepth(Graph G, int s, int k);
+
+// Runs BFS with source s over the Graph of this Search, storing the result in
+// S rather than in the Graph. Searches over the same Graph may run in parallel
+// as long as no edges are added while they do.
+void searchBFS(Search S, int s);
+
+// Same as BFSDepth(), but stores the result in the Search S
+int searchDepth(Search S, int s, int k);
+
+// Runs BFS on the Graph G with source s, to depth k (or without a limit
+// if k is negative), calling onVertex on each vertex as it is discovered and
+// onLevel on each level once all of its vertices are known. Either may be
+// NULL. Returns true (1) if the search ran to the end, otherwise false (0).
+// A search that is stopped keeps what it has found so far: the vertices
+// discovered have their distances and parents, and the levels reached so
+// far, the last of which may be only partly discovered, can be read back.
+int visitBFS(Graph G, int s, int k, VisitVertex onVertex, VisitLevel onLevel, void* context);
+
+// Same as visitBFS(), but stores the result in the Search S
+int searchVisit(Search S, int s, int k, VisitVertex onVertex, VisitLevel onLevel, void* context);
+
+// Visitor for visitBFS() and searchVisit() that stops the search once it
+// finds the vertex its context points to
+int stopAtVertex(void* context, int v, int parent, int d);
+
+// Runs BFS on the Graph G from s along arcs followed backwards, so it finds
+// the vertices that can reach s. Afterwards getDist(G, u) is the length of
+// a shortest path from u to s, getParent(G, u) is the vertex after u on such
+// a path, and getPath(G, u) gives that path from s back to u. The transpose
+// of G is built in CSR form the first time it is wanted after G changes.
+// An undirected graph, one with no arcs added or removed on their own, is
+// its own transpose, so this is then the same as BFS().
+void reverseBFS(Graph G, int s);
+
+// Same as reverseBFS(), but stores the result in the Search S
+void searchReverse(Search S, int s);
+
+// Finds a shortest path from s to t in the Graph of S by bidirectional BFS:
+// one search goes forward from s along arcs and another backward from t
+// along the transpose, a whole level at a time, each time on the side with
+// the smaller frontier, until they meet. Appends the path to L, or NIL if
+// there is none, and returns its length, or INF. Often reads far less of
+// the graph than BFS() would, but of several shortest paths it may find a
+// different one. The result of S's last search is left as it was.
+int searchBetween(Search S, int s, int t, List L);
+
+// Finds the shortest paths in G from source s, where the length of a path
+// is the sum of the weights of its edges, setting the distance, parent, and
+// source fields of G so that getDist() and getPath() work as after BFS().
+// Uses 0-1 BFS if every weight is 0 or 1, and Dijkstra's algorithm with a
+// radix heap otherwise. The distances must fit in an int.
+void shortestPaths(Graph G, int s);
+
+// Same as shortestPaths(), but stores the result in the Search S
+void searchWeighted(Search S, int s);
+
+// Runs BFS on the Graph G with source s, as BFS() does, and also counts the
+// shortest paths from s to every vertex and records the shortest-path DAG,
+// so that getPathCount() and the PathIterator functions can be used. Path
+// lengths count edges, and parallel edges make for different paths.
+void countBFS(Graph G, int s);
+
+// Same as countBFS(), but stores the result in the Search S
+void searchCount(Search S, int s);
+
+// Returns the number of shortest paths from the source of the most recent
+// call to countBFS() to u, or ULLONG_MAX if there are at least that many
+unsigned long long getPathCount(Graph G, int u);
+
+// Same as getPathCount(), but for the most recent searchCount() on S
+unsigned long long searchPathCount(Search S, int u);
+
+// Returns a new PathIterator over the shortest paths from the source of the
+// most recent searchCount() on S to u. It reads the shortest-path DAG of S,
+// and must not be used once S has run again.
+PathIterator newPathIterator(Search S, int u);
+
+// Frees all dynamic memory associated with the PathIterator
+// *pI, then sets the handle *pI to NULL.
+void freePathIterator(PathIterator* pI);
+
+// Appends to the List L the vertices of the next shortest path of I, from
+// the source to the target, and returns true (1), or returns false (0) and
+// leaves L alone if every path has been returned. Only one path is held at
+// a time, so the paths can be walked through however many there are.
+int nextPath(PathIterator I, List L);
+
 // Other operations -----------------------------------------------------------
 
-// Prints the adjacency list representation of G to the file pointed to by out
+// Prints the adjacency list representation of G to the file pointed to by out.
+// In a weighted graph each neighbor is followed by the edge weight in parentheses.
 void printGraph(FILE* out, Graph G);
 
+// Prints to out where the pages of each array of G and of its own Search
+// live, as reported by printArrayPlacement() in Memory.h
+void printPlacement(FILE* out, Graph G);
+
+// Writes the result of the most recent run of S (its source, parents,
+// distances and levels) to the file at path in a compact binary form that
+// loadSearch() maps back in. The file is written under a temporary name no
+// other process can be using, and then renamed, so that readers never see
+// half of it. Returns true (1) if the file was written, otherwise false (0).
+int saveSearch(Search S, char* path);
+
+// Maps the file at path, written by saveSearch(), into S so that its source,
+// parents, distances and levels can be read through the search functions
+// without running BFS again. Nothing is copied: the arrays of S point into
+// the mapping until S runs again or is freed. Returns true (1) if the file
+// was loaded, or false (0), leaving S as it was, if it can't be read, holds
+// a vertex out of range, or wasn't saved from a graph with the same edges
+// (and weights) as that of S.
+int loadSearch(Search S, char* path);
+
 #endif
 
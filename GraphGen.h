@@ -0,0 +1,300 @@
+#ifndef _GRAPHGEN_H_INCLUDE_
+#define _GRAPHGEN_H_INCLUDE_
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Memory.h"
+
+// Graph variants specialized at compile time ---------------------------------
+//
+// GRAPH_DECLARE() and GRAPH_DEFINE() generate a read-only graph type in CSR
+// form, for graphs that are loaded once and then searched, specialized for
+//   - the vertex type V, an unsigned integer type such as uint32_t, or
+//     uint64_t for graphs beyond 2^31 vertices or edges,
+//   - DIRECTED: 1 if each edge u v is an arc from u to v only, 0 if it joins
+//     u and v both ways, as addEdge() does,
+//   - PARENTS: 1 if BFS records the parent of each vertex, 0 if it only
+//     records distances, so that it never writes a parent array at all.
+// DIRECTED and PARENTS are constants inside the generated code, so each
+// variant compiles down to just the branches it needs. Vertices are labeled
+// 1 to n as in Graph; GRAPH_NIL stands for no vertex and GRAPH_INF(V) for
+// an unreached distance, the largest value of V.
+//
+// GRAPH_DECLARE(Type, prefix, V) declares, for Type "HopGraph" and prefix
+// "hopGraph" say, the following, which the comments describe in terms of
+// a Type G:
+//
+// Type newType(V n, const V* edge, long m, int policy)
+//     Returns a new graph of n vertices with the m edges edge[2i] edge[2i+1],
+//     for i from 0 to m-1, whose arrays are allocated with the given policy
+//     (see Memory.h). Each adjacency list is kept in sorted order, so BFS
+//     discovers vertices in the same order as BFS() does on a Graph built
+//     from the same edges. Exits with an error if an edge is improper.
+// void freeType(Type* pG)
+//     Frees all memory associated with *pG, then sets *pG to NULL.
+// V prefixOrder(Type G)
+//     Returns the number of vertices of G.
+// long prefixSize(Type G)
+//     Returns the number of edges of G.
+// void prefixBFS(Type G, V s)
+//     Runs BFS from s over G.
+// V prefixDist(Type G, V u)
+//     Returns the distance from the most recent BFS source to u, or
+//     GRAPH_INF(V) if u wasn't reached or BFS has not run.
+// V prefixParent(Type G, V u)
+//     Returns the parent of u in the most recent BFS tree, or GRAPH_NIL.
+//     Exits with an error if the variant doesn't record parents.
+// V prefixPath(Type G, V u, V* path)
+//     Writes the vertices of a shortest path from the most recent BFS source
+//     to u into path, which must have room for prefixDist(G, u)+1 of them,
+//     and returns how many there are, or 0 if there is no such path. Exits
+//     with an error if the variant doesn't record parents.
+// V prefixReached(Type G)
+//     Returns the number of vertices reached by the most recent BFS.
+// V prefixVisited(Type G, V i)
+//     Returns the ith vertex discovered by the most recent BFS, from 0 for
+//     the source, so the last one reached is one of the farthest.
+//
+// GRAPH_DEFINE(Type, prefix, V, DIRECTED, PARENTS) defines them, in exactly
+// one translation unit.
+
+#define GRAPH_NIL 0
+#define GRAPH_INF(V) ((V)~(V)0)
+
+#define GRAPH_DECLARE(Type, prefix, V)                                        \
+typedef struct Type##Obj* Type;                                               \
+Type new##Type(V n, const V* edge, long m, int policy);                       \
+void free##Type(Type* pG);                                                    \
+V prefix##Order(Type G);                                                      \
+long prefix##Size(Type G);                                                    \
+void prefix##BFS(Type G, V s);                                                \
+V prefix##Dist(Type G, V u);                                                  \
+V prefix##Parent(Type G, V u);                                                \
+V prefix##Path(Type G, V u, V* path);                                         \
+V prefix##Reached(Type G);                                                    \
+V prefix##Visited(Type G, V i);
+
+#define GRAPH_DEFINE(Type, prefix, V, DIRECTED, PARENTS)                      \
+                                                                              \
+/* The neighbors of vertex i are target[offset[i]] through                    \
+   target[offset[i+1]-1], in sorted order. queue holds the vertices           \
+   reached by the most recent BFS in the order they were discovered, and      \
+   parent is NULL unless the variant records parents. */                      \
+typedef struct Type##Obj {                                                    \
+    V order;                                                                  \
+    long size;                                                                \
+    long* offset;                                                             \
+    V* target;                                                                \
+    V* distance;                                                              \
+    V* parent;                                                                \
+    V* queue;                                                                 \
+    V reached;                                                                \
+    V source;                                                                 \
+} Type##Obj;                                                                  \
+                                                                              \
+/* Returns a new array of n elements of the given size, allocated with the   \
+   given policy. Exits with an error if there isn't enough memory for it. */  \
+static void* prefix##Array(long n, size_t size, int policy) {                 \
+    void* A = newArray(n * size, policy);                                     \
+    if(A == NULL) {                                                           \
+        printf(#Type " Error: unable to allocate %ld bytes\n", (long)(n * size)); \
+        exit(1);                                                              \
+    }                                                                         \
+    return(A);                                                                \
+}                                                                             \
+                                                                              \
+/* Orders vertices for qsort() */                                             \
+static int prefix##Compare(const void* a, const void* b) {                    \
+    V x = *(const V*)a;                                                       \
+    V y = *(const V*)b;                                                       \
+    return((x > y) - (x < y));                                                \
+}                                                                             \
+                                                                              \
+/* Checks that G isn't NULL, for the function named name */                 \
+static void prefix##Exists(Type G, const char* name) {                        \
+    if(G == NULL) {                                                           \
+        printf(#Type " Error: calling %s() on NULL " #Type " reference\n", name); \
+        exit(1);                                                              \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+/* Checks that G isn't NULL and u is a vertex of it, for the function        \
+   named name */                                                              \
+static void prefix##Check(Type G, V u, const char* name) {                    \
+    prefix##Exists(G, name);                                                  \
+    if(u<1 || u>G->order) {                                                   \
+        printf(#Type " Error: %s() called on improper vertex\n", name);       \
+        exit(1);                                                              \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+Type new##Type(V n, const V* edge, long m, int policy) {                      \
+                                                                              \
+    Type G = malloc(sizeof(Type##Obj));                                       \
+    if(G == NULL) {                                                           \
+        printf(#Type " Error: unable to allocate a graph\n");                 \
+        exit(1);                                                              \
+    }                                                                         \
+    G->order = n;                                                             \
+    G->size = m;                                                              \
+    G->offset = prefix##Array((long)n+2, sizeof(long), policy);               \
+    G->distance = prefix##Array((long)n+1, sizeof(V), policy);                \
+    G->parent = PARENTS ? prefix##Array((long)n+1, sizeof(V), policy) : NULL; \
+    G->queue = prefix##Array((long)n+1, sizeof(V), policy);                   \
+    G->reached = 0;                                                           \
+    G->source = GRAPH_NIL;                                                    \
+                                                                              \
+    /* Count the neighbors of every vertex to find where each one starts */   \
+    for(long i=0; i<(long)n+2; i++) {                                         \
+        G->offset[i] = 0;                                                     \
+    }                                                                         \
+    for(long k=0; k<m; k++) {                                                 \
+        V u = edge[2*k];                                                      \
+        V v = edge[2*k+1];                                                    \
+        if(u<1 || u>n || v<1 || v>n) {                                        \
+            printf(#Type " Error: new" #Type "() called with improper edge %ld\n", k); \
+            exit(1);                                                          \
+        }                                                                     \
+        G->offset[u+1]++;                                                     \
+        if(!DIRECTED) {                                                       \
+            G->offset[v+1]++;                                                 \
+        }                                                                     \
+    }                                                                         \
+    for(long i=1; i<(long)n+1; i++) {                                         \
+        G->offset[i+1] += G->offset[i];                                       \
+    }                                                                         \
+                                                                              \
+    /* Place each edge in its slice, using distance[] to count how many      \
+       neighbors each slice already has, then sort the slices */              \
+    G->target = prefix##Array(G->offset[n+1]+1, sizeof(V), policy);           \
+    for(long i=1; i<(long)n+1; i++) {                                         \
+        G->distance[i] = 0;                                                   \
+    }                                                                         \
+    for(long k=0; k<m; k++) {                                                 \
+        V u = edge[2*k];                                                      \
+        V v = edge[2*k+1];                                                    \
+        G->target[G->offset[u] + G->distance[u]++] = v;                       \
+        if(!DIRECTED) {                                                       \
+            G->target[G->offset[v] + G->distance[v]++] = u;                   \
+        }                                                                     \
+    }                                                                         \
+    for(long i=1; i<(long)n+1; i++) {                                         \
+        qsort(G->target + G->offset[i], G->offset[i+1] - G->offset[i],        \
+              sizeof(V), prefix##Compare);                                    \
+        G->distance[i] = GRAPH_INF(V);                                        \
+        if(PARENTS) {                                                         \
+            G->parent[i] = GRAPH_NIL;                                         \
+        }                                                                     \
+    }                                                                         \
+                                                                              \
+    return(G);                                                                \
+}                                                                             \
+                                                                              \
+void free##Type(Type* pG) {                                                   \
+    if(pG!=NULL && *pG!=NULL) {                                               \
+        freeArray((*pG)->offset);                                             \
+        freeArray((*pG)->target);                                             \
+        freeArray((*pG)->distance);                                           \
+        freeArray((*pG)->parent);                                             \
+        freeArray((*pG)->queue);                                              \
+        free(*pG);                                                            \
+        *pG = NULL;                                                           \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+V prefix##Order(Type G) {                                                     \
+    prefix##Exists(G, #prefix "Order");                                       \
+    return(G->order);                                                         \
+}                                                                             \
+                                                                              \
+long prefix##Size(Type G) {                                                   \
+    prefix##Exists(G, #prefix "Size");                                        \
+    return(G->size);                                                          \
+}                                                                             \
+                                                                              \
+void prefix##BFS(Type G, V s) {                                               \
+                                                                              \
+    prefix##Check(G, s, #prefix "BFS");                                       \
+    V* distance = G->distance;                                                \
+    V* parent = G->parent;                                                    \
+    V* queue = G->queue;                                                      \
+    const long* offset = G->offset;                                           \
+    const V* target = G->target;                                              \
+                                                                              \
+    /* Only the vertices reached last time need resetting */                  \
+    for(V i=0; i<G->reached; i++) {                                           \
+        distance[queue[i]] = GRAPH_INF(V);                                    \
+        if(PARENTS) {                                                         \
+            parent[queue[i]] = GRAPH_NIL;                                     \
+        }                                                                     \
+    }                                                                         \
+                                                                              \
+    V head = 0;                                                               \
+    V tail = 1;                                                               \
+    distance[s] = 0;                                                          \
+    queue[0] = s;                                                             \
+    while(head < tail) {                                                      \
+        V x = queue[head++];                                                  \
+        V d = distance[x] + 1;                                                \
+        for(long j=offset[x]; j<offset[x+1]; j++) {                           \
+            V y = target[j];                                                  \
+            if(distance[y] == GRAPH_INF(V)) {                                 \
+                distance[y] = d;                                              \
+                if(PARENTS) {                                                 \
+                    parent[y] = x;                                            \
+                }                                                             \
+                queue[tail++] = y;                                            \
+            }                                                                 \
+        }                                                                     \
+    }                                                                         \
+    G->reached = tail;                                                        \
+    G->source = s;                                                            \
+}                                                                             \
+                                                                              \
+V prefix##Dist(Type G, V u) {                                                 \
+    prefix##Check(G, u, #prefix "Dist");                                      \
+    return(G->distance[u]);                                                   \
+}                                                                             \
+                                                                              \
+V prefix##Parent(Type G, V u) {                                               \
+    prefix##Check(G, u, #prefix "Parent");                                    \
+    if(!PARENTS) {                                                            \
+        printf(#Type " Error: " #prefix "Parent() called on a graph that doesn't record parents\n"); \
+        exit(1);                                                              \
+    }                                                                         \
+    return(G->parent[u]);                                                     \
+}                                                                             \
+                                                                              \
+V prefix##Path(Type G, V u, V* path) {                                        \
+    prefix##Check(G, u, #prefix "Path");                                      \
+    if(!PARENTS) {                                                            \
+        printf(#Type " Error: " #prefix "Path() called on a graph that doesn't record parents\n"); \
+        exit(1);                                                              \
+    }                                                                         \
+    V length = G->distance[u];                                                \
+    if(length == GRAPH_INF(V)) {                                              \
+        return 0;                                                             \
+    }                                                                         \
+    V x = u;                                                                  \
+    for(V i=length+1; i>0; i--) {                                             \
+        path[i-1] = x;                                                        \
+        x = G->parent[x];                                                     \
+    }                                                                         \
+    return(length+1);                                                         \
+}                                                                             \
+                                                                              \
+V prefix##Reached(Type G) {                                                   \
+    prefix##Exists(G, #prefix "Reached");                                     \
+    return(G->reached);                                                       \
+}                                                                             \
+                                                                              \
+V prefix##Visited(Type G, V i) {                                              \
+    prefix##Exists(G, #prefix "Visited");                                     \
+    if(i >= G->reached) {                                                     \
+        printf(#Type " Error: " #prefix "Visited() called on improper index\n"); \
+        exit(1);                                                              \
+    }                                                                         \
+    return(G->queue[i]);                                                      \
+}
+
+#endif
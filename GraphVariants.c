@@ -0,0 +1,9 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "GraphVariants.h"
+
+GRAPH_DEFINE(HopGraph, hopGraph, uint32_t, 0, 0)
+
+GRAPH_DEFINE(ArcGraph, arcGraph, uint32_t, 1, 1)
+
+GRAPH_DEFINE(BigGraph, bigGraph, uint64_t, 0, 1)
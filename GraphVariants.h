@@ -0,0 +1,20 @@
+#ifndef _GRAPHVARIANTS_H_INCLUDE_
+#define _GRAPHVARIANTS_H_INCLUDE_
+#include <stdint.h>
+#include "GraphGen.h"
+
+// Graph variants generated by GraphGen.h. Graph itself remains the general
+// graph, which can change, carry weights and be searched by many threads.
+
+// Undirected, 32-bit vertices, distances only: for searches that only need
+// to know how far away each vertex is
+GRAPH_DECLARE(HopGraph, hopGraph, uint32_t)
+
+// Directed, 32-bit vertices, with parents
+GRAPH_DECLARE(ArcGraph, arcGraph, uint32_t)
+
+// Undirected, 64-bit vertices, with parents: for graphs of 2^31 vertices
+// or more, which Graph can't label
+GRAPH_DECLARE(BigGraph, bigGraph, uint64_t)
+
+#endif
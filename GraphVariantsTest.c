@@ -0,0 +1,145 @@
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+#include"Graph.h"
+#include"GraphVariants.h"
+
+// Smoke test for the graph variants of GraphVariants.h. Builds a few random
+// graphs both as a Graph and as each variant that can hold them, runs BFS
+// from every vertex of each, and checks that every variant finds the same
+// distances as BFS(), the same paths as getPath() where it records parents,
+// and reaches the same number of vertices.
+
+// Number of graphs checked, and the largest order of one
+#define ROUNDS 20
+#define ORDER 60
+
+// Number of mismatches found
+static int failures = 0;
+
+// Reports a mismatch between a variant and the Graph
+static void fail(const char* variant, int round, int s, int u, const char* what) {
+    if(failures++ < 10) {
+        printf("%s: round %d, source %d, vertex %d: %s differs from the Graph\n", variant, round, s, u, what);
+    }
+}
+
+// Returns true (1) if the n vertices of path P are the vertices of L
+static int samePath(List L, const uint64_t* P, uint64_t n) {
+    if(length(L) != (int)n) {
+        return 0;
+    }
+    int i = 0;
+    for(moveFront(L); place(L)>=0; moveNext(L)) {
+        if((uint64_t)get(L) != P[i++]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main(void) {
+
+    srand(1);
+    List L = newList();
+    uint32_t* E32 = malloc(2 * ORDER * ORDER * sizeof(uint32_t));
+    uint64_t* E64 = malloc(2 * ORDER * ORDER * sizeof(uint64_t));
+    uint32_t* P32 = malloc((ORDER+1) * sizeof(uint32_t));
+    uint64_t* P64 = malloc((ORDER+1) * sizeof(uint64_t));
+
+    for(int r=0; r<ROUNDS; r++) {
+        int n = 1 + rand() % ORDER;
+        long m = rand() % (2*n + 1);
+
+        // The same random edges as an undirected and a directed Graph
+        Graph U = newGraph(n);
+        Graph D = newGraph(n);
+        for(long k=0; k<m; k++) {
+            int u = 1 + rand() % n;
+            int v = 1 + rand() % n;
+            addEdge(U, u, v);
+            addArc(D, u, v);
+            E32[2*k] = u;
+            E32[2*k+1] = v;
+            E64[2*k] = u;
+            E64[2*k+1] = v;
+        }
+        HopGraph H = newHopGraph(n, E32, m, ALLOC_DEFAULT);
+        ArcGraph A = newArcGraph(n, E32, m, ALLOC_DEFAULT);
+        BigGraph B = newBigGraph(n, E64, m, ALLOC_DEFAULT);
+
+        for(int s=1; s<n+1; s++) {
+            int reachedU = 0, reachedD = 0;
+
+            BFS(U, s);
+            hopGraphBFS(H, s);
+            bigGraphBFS(B, s);
+            for(int u=1; u<n+1; u++) {
+                int d = getDist(U, u);
+                uint32_t h = hopGraphDist(H, u);
+                uint64_t b = bigGraphDist(B, u);
+                reachedU += (d != INF);
+                if(d==INF ? h!=GRAPH_INF(uint32_t) : h!=(uint32_t)d) {
+                    fail("HopGraph", r, s, u, "distance");
+                }
+                if(d==INF ? b!=GRAPH_INF(uint64_t) : b!=(uint64_t)d) {
+                    fail("BigGraph", r, s, u, "distance");
+                }
+                clear(L);
+                getPath(L, U, u);
+                uint64_t k = bigGraphPath(B, u, P64);
+                if(d!=INF && !samePath(L, P64, k)) {
+                    fail("BigGraph", r, s, u, "path");
+                }
+            }
+            if(hopGraphReached(H)!=(uint32_t)reachedU || bigGraphReached(B)!=(uint64_t)reachedU) {
+                fail("HopGraph or BigGraph", r, s, 0, "number reached");
+            }
+
+            BFS(D, s);
+            arcGraphBFS(A, s);
+            for(int u=1; u<n+1; u++) {
+                int d = getDist(D, u);
+                uint32_t a = arcGraphDist(A, u);
+                reachedD += (d != INF);
+                if(d==INF ? a!=GRAPH_INF(uint32_t) : a!=(uint32_t)d) {
+                    fail("ArcGraph", r, s, u, "distance");
+                }
+                if(d == INF) {
+                    continue;
+                }
+                clear(L);
+                getPath(L, D, u);
+                uint32_t k = arcGraphPath(A, u, P32);
+                for(uint32_t i=0; i<k; i++) {
+                    P64[i] = P32[i];
+                }
+                if(!samePath(L, P64, k)) {
+                    fail("ArcGraph", r, s, u, "path");
+                }
+            }
+            if(arcGraphReached(A) != (uint32_t)reachedD) {
+                fail("ArcGraph", r, s, 0, "number reached");
+            }
+        }
+
+        freeHopGraph(&H);
+        freeArcGraph(&A);
+        freeBigGraph(&B);
+        freeGraph(&U);
+        freeGraph(&D);
+    }
+
+    free(E32);
+    free(E64);
+    free(P32);
+    free(P64);
+    freeList(&L);
+
+    if(failures > 0) {
+        printf("%d mismatches\n", failures);
+        return(1);
+    }
+    printf("All graph variants agree\n");
+    return(0);
+}
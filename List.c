@@ -1,14 +1,21 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "List.h"
 
+// Number of elements a Node holds, so that a Node (the elements, their
+// count and two pointers) fills two 64-byte cache lines
+#define BLOCK 27
+
 // structs --------------------------------------------------------------------
 
 // Private NodeObj type
-// Contains fields for data and pointers to the next and 
-// previous Nodes of the cursor Node of the List.
+// Contains a block of up to BLOCK consecutive elements of the List, the
+// number of them in use, and pointers to the next and previous Nodes.
+// Every Node of a List holds at least one element.
 typedef struct NodeObj {
-    int data;
+    int count;
+    int data[BLOCK];
     struct NodeObj* next;
     struct NodeObj* prev;
 } NodeObj;
@@ -17,23 +24,35 @@ typedef struct NodeObj {
 typedef NodeObj* Node;
 
 // Private ListObj type
-// Contains fields for front, back, and cursor Nodes of the List
-// and the length of the List and the index of the cursor Node.
+// Contains fields for front, back, and cursor Nodes of the List, the
+// position of the cursor element within the cursor Node, and the
+// length of the List and the index of the cursor element, along with
+// the number of Nodes and the counter their bytes are charged to, if any.
 typedef struct ListObj {
     Node front;
     Node back;
     Node cursor;
+    int offset;
     int length;
     int index;
+    int nodes;
+    long* counter;
 } ListObj;
 
 // Constructors-Destructors ---------------------------------------------------
 
 // Returns reference to new Node object
-// Initializes data, next, and prev fields of the Node object
-Node newNode(int data) {
+// Initializes the count, next, and prev fields of the Node object
+Node newNode(void) {
     Node N = malloc(sizeof(NodeObj));
-    N->data = data;
+
+    // Make sure there was memory allocated for the Node
+    if(N == NULL) {
+        printf("List Error: unable to allocate %ld bytes\n", (long)sizeof(NodeObj));
+        exit(1);
+    }
+
+    N->count = 0;
     N->next = NULL;
     N->prev = NULL;
     return(N);
@@ -48,28 +67,168 @@ void freeNode(Node* pN) {
 }
 
 // Returns reference to new empty List object
-// Initializes the front, back, and cursor Nodes to NULL and the 
-// length of the List to 0 and the index of the cursor Node to -1.
+// Initializes the front, back, and cursor Nodes to NULL and the
+// length of the List to 0 and the index of the cursor element to -1.
 List newList(void) {
     List L;
     L = malloc(sizeof(ListObj));
+
+    // Make sure there was memory allocated for the List
+    if(L == NULL) {
+        printf("List Error: unable to allocate %ld bytes\n", (long)sizeof(ListObj));
+        exit(1);
+    }
+
     L->front = L->back = L->cursor = NULL;
+    L->offset = 0;
     L->length = 0;
     L->index = -1;
+    L->nodes = 0;
+    L->counter = NULL;
     return(L);
 }
 
 // Frees all heap memory associated with its List* argument, and sets *pL to NULL
 void freeList(List* pL) {
-    if(pL!=NULL && *pL!=NULL) { 
-        while( !isEmpty(*pL) ) { 
-            deleteFront(*pL); 
+    if(pL!=NULL && *pL!=NULL) {
+        clear(*pL);
+        if((*pL)->counter != NULL) {
+            *(*pL)->counter -= sizeof(ListObj);
         }
         free(*pL);
         *pL = NULL;
     }
 }
 
+// Private helpers ------------------------------------------------------------
+
+// Counts k more Nodes (or fewer, if k is negative) as belonging to L,
+// and charges their bytes to the counter of L
+static void chargeNodes(List L, int k) {
+    L->nodes += k;
+    if(L->counter != NULL) {
+        *L->counter += k * (long)sizeof(NodeObj);
+    }
+}
+
+// Links the new Node M into L right after N, or at the front if N is NULL
+static void linkAfter(List L, Node N, Node M) {
+    chargeNodes(L, 1);
+    M->prev = N;
+    M->next = (N != NULL) ? N->next : L->front;
+    if(M->next != NULL) {
+        M->next->prev = M;
+    } else {
+        L->back = M;
+    }
+    if(N != NULL) {
+        N->next = M;
+    } else {
+        L->front = M;
+    }
+}
+
+// Unlinks the Node N from L and frees it
+static void unlinkNode(List L, Node N) {
+    chargeNodes(L, -1);
+    if(N->prev != NULL) {
+        N->prev->next = N->next;
+    } else {
+        L->front = N->next;
+    }
+    if(N->next != NULL) {
+        N->next->prev = N->prev;
+    } else {
+        L->back = N->prev;
+    }
+    freeNode(&N);
+}
+
+// Inserts data at position i of the Node N, which may be N->count to
+// insert after its last element. A full Node gets a new Node next to it
+// if data goes at either end, so that Lists built by prepend() and
+// append() keep their Nodes full, and is split in half otherwise.
+// Keeps the cursor on the same element, but leaves the length and
+// the index of the cursor to the caller.
+static void insertAt(List L, Node N, int i, int data) {
+
+    if(N->count == BLOCK) {
+        Node M = newNode();
+        if(i == BLOCK) {
+            // Start a new Node after N
+            linkAfter(L, N, M);
+            N = M;
+            i = 0;
+        } else if(i == 0) {
+            // Start a new Node before N
+            linkAfter(L, N->prev, M);
+            N = M;
+        } else {
+            // Move the upper half of N to a new Node after it
+            int half = BLOCK / 2;
+            M->count = BLOCK - half;
+            memcpy(M->data, N->data + half, M->count * sizeof(int));
+            N->count = half;
+            linkAfter(L, N, M);
+            if(L->cursor==N && L->offset>=half) {
+                L->cursor = M;
+                L->offset -= half;
+            }
+            if(i > half) {
+                N = M;
+                i -= half;
+            }
+        }
+    }
+
+    // Shift the elements from i on up by one to make room
+    memmove(N->data + i + 1, N->data + i, (N->count - i) * sizeof(int));
+    N->data[i] = data;
+    N->count++;
+    if(L->cursor==N && L->offset>=i) {
+        L->offset++;
+    }
+}
+
+// Removes the element at position i of the Node N, unlinking N if it
+// becomes empty, or merging it with a neighboring Node if the two fit in
+// one, so that a List never holds many nearly empty Nodes. Keeps the
+// cursor on the same element, so the cursor element must not be the one
+// removed, but leaves the length and the index of the cursor to the caller.
+static void removeAt(List L, Node N, int i) {
+
+    memmove(N->data + i, N->data + i + 1, (N->count - i - 1) * sizeof(int));
+    N->count--;
+    if(L->cursor==N && L->offset>i) {
+        L->offset--;
+    }
+
+    if(N->count == 0) {
+        unlinkNode(L, N);
+        return;
+    }
+
+    // Merge N with the Node after it, or the one before, if it
+    // has become less than half full and the two fit in one
+    if(N->count < BLOCK/2) {
+        Node A = N;
+        Node B = N->next;
+        if(B==NULL || A->count+B->count>BLOCK) {
+            A = N->prev;
+            B = N;
+        }
+        if(A!=NULL && B!=NULL && A->count+B->count<=BLOCK) {
+            memcpy(A->data + A->count, B->data, B->count * sizeof(int));
+            if(L->cursor == B) {
+                L->cursor = A;
+                L->offset += A->count;
+            }
+            A->count += B->count;
+            unlinkNode(L, B);
+        }
+    }
+}
+
 // Access functions -----------------------------------------------------------
 
 // Returns true (1) if this List is empty, otherwise returns false (0)
@@ -121,7 +280,7 @@ int front(List L){
         exit(1);
     }
 
-    return(L->front->data);
+    return(L->front->data[0]);
 }
 
 // Returns the back element of this List
@@ -138,7 +297,7 @@ int back(List L){
         exit(1);
     }
 
-    return(L->back->data);
+    return(L->back->data[L->back->count-1]);
 }
 
 // Returns the cursor element of this List
@@ -156,7 +315,7 @@ int get(List L){
         exit(1);
     }
 
-    return(L->cursor->data);
+    return(L->cursor->data[L->offset]);
 }
 
 // Returns true (1) if the Lists are identical, false (0) otherwise
@@ -164,6 +323,8 @@ int equals(List A, List B){
     int eq = 0;
     Node N = NULL;
     Node M = NULL;
+    int i = 0;
+    int j = 0;
 
     // Check if either of the Lists inputted are NULL
     if( A==NULL || B==NULL ){
@@ -178,15 +339,40 @@ int equals(List A, List B){
     M = B->front;
 
     // Execute the loop if the elements of the Lists are equal and if the Lists
-    // are not NULL
+    // are not NULL, comparing as many elements at a time as are left in
+    // the current blocks of both Lists
     while(eq && N!=NULL){
-        eq = (N->data==M->data);
-        N = N->next;
-        M = M->next;
+        int run = N->count - i;
+        if(M->count - j < run) {
+            run = M->count - j;
+        }
+        eq = (memcmp(N->data + i, M->data + j, run * sizeof(int)) == 0);
+        i += run;
+        j += run;
+        if(i == N->count) {
+            N = N->next;
+            i = 0;
+        }
+        if(j == M->count) {
+            M = M->next;
+            j = 0;
+        }
     }
     return eq;
 }
 
+// Returns the number of bytes of heap memory this List holds
+long listBytes(List L) {
+
+    // Check if the List is NULL
+    if( L==NULL ) {
+        printf("List Error: calling listBytes() on NULL List reference\n");
+        exit(1);
+    }
+
+    return(sizeof(ListObj) + L->nodes * (long)sizeof(NodeObj));
+}
+
 // Manipulation procedures ----------------------------------------------------
 
 // Empties this List and sets it back to its default state
@@ -197,14 +383,19 @@ void clear(List L) {
         printf("List Error: calling clear() on NULL List reference\n");
         exit(1);
     }
-    
-    // Keep deleting the front Node if the List is not empty
-    while( !isEmpty(L) ) { 
-        deleteFront(L); 
+
+    // Free every Node of the List
+    Node N = L->front;
+    while(N != NULL) {
+        Node M = N->next;
+        freeNode(&N);
+        N = M;
     }
+    chargeNodes(L, -L->nodes);
 
     // Set the List back to its default state
     L->front = L->back = L->cursor = NULL;
+    L->offset = 0;
     L->length = 0;
     L->index = -1;
 }
@@ -222,6 +413,7 @@ void moveFront(List L) {
     // Checks if the List is empty
     if(L->length > 0) {
         L->cursor = L->front;
+        L->offset = 0;
         L->index = 0;
     }
 }
@@ -239,6 +431,7 @@ void moveBack(List L) {
     // Check if the List is empty
     if(L->length > 0) {
         L->cursor = L->back;
+        L->offset = L->back->count-1;
         L->index = L->length-1;
     }
 }
@@ -251,14 +444,19 @@ void movePrev(List L) {
         exit(1);
     }
 
-    // If the cursor is defined and not at the front, move the
-    // cursor to its previous Node
-    if(L->cursor!=NULL && L->cursor!=L->front) {
-        L->cursor = L->cursor->prev;
+    // If the cursor is defined and not at the front, move the cursor
+    // to its previous element, in the previous Node if it is the first
+    if(L->cursor!=NULL && L->index>0) {
+        if(L->offset > 0) {
+            L->offset--;
+        } else {
+            L->cursor = L->cursor->prev;
+            L->offset = L->cursor->count-1;
+        }
         L->index--;
-    
+
     // If the cursor is defined and at the front, cursor becomes undefined
-    } else if(L->cursor!=NULL && L->cursor==L->front) {
+    } else if(L->cursor != NULL) {
         L->cursor = NULL;
         L->index = -1;
     }
@@ -272,14 +470,19 @@ void moveNext(List L) {
         exit(1);
     }
 
-    // If the cursor is defined and not at the back, move the
-    // cursor to its next Node
-    if(L->cursor!=NULL && L->cursor!=L->back) {
-        L->cursor = L->cursor->next;
+    // If the cursor is defined and not at the back, move the cursor
+    // to its next element, in the next Node if it is the last
+    if(L->cursor!=NULL && L->index<L->length-1) {
+        if(L->offset < L->cursor->count-1) {
+            L->offset++;
+        } else {
+            L->cursor = L->cursor->next;
+            L->offset = 0;
+        }
         L->index++;
 
     // If the cursor is defined and at the back, cursor becomes undefined
-    } else if(L->cursor!=NULL && L->cursor==L->back) {
+    } else if(L->cursor != NULL) {
         L->cursor = NULL;
         L->index = -1;
     }
@@ -293,18 +496,16 @@ void prepend(List L, int data) {
         exit(1);
     }
 
-    // Create new Node
-    Node N = newNode(data);
-
-    // If the List is empty, insert the new Node, so the new 
-    // Node is now the front and back Node of the List
+    // If the List is empty, the new element gets a Node of its own,
+    // which is now the front and back Node of the List
     if(L->length < 1) {
-        L->front = L->back = N;
-    // Else, insert the Node at the front of the List, so the new Node is now the front Node
+        Node N = newNode();
+        linkAfter(L, NULL, N);
+        N->data[0] = data;
+        N->count = 1;
+    // Else, insert the element at the front of the List
     } else {
-        L->front->prev = N;
-        N->next = L->front;
-        L->front = N;
+        insertAt(L, L->front, 0, data);
         if(L->index != -1) {
             L->index++;
         }
@@ -320,18 +521,16 @@ void append(List L, int data) {
         exit(1);
     }
 
-    // Create a new Node
-    Node N = newNode(data);
-
-    // If the List is empty, insert the new Node, so the new 
-    // Node is now the front and back Node of the List
-    if(L->length < 1) { 
-        L->front = L->back = N;
-    // Else, insert the Node at the back of the List, so the new Node is now the back Node
-    } else { 
-        L->back->next = N;
-        N->prev = L->back;
-        L->back = N;
+    // If the List is empty, the new element gets a Node of its own,
+    // which is now the front and back Node of the List
+    if(L->length < 1) {
+        Node N = newNode();
+        linkAfter(L, NULL, N);
+        N->data[0] = data;
+        N->count = 1;
+    // Else, insert the element at the back of the List
+    } else {
+        insertAt(L, L->back, L->back->count, data);
     }
     L->length++;
 }
@@ -349,31 +548,11 @@ void insertBefore(List L, int data) {
         exit(1);
     }
 
-    if(L->length > 0) {
-
-        // If the cursor is the front Node, insert the new Node
-        // into the front of the List, so the new Node now becomes the front Node
-        if(L->index == 0) {
-            Node N = newNode(data);
-            L->cursor->prev = N;
-            N->next = L->cursor;
-            L->front = N;
-            L->length++;
-            L->index++;
-
-        // If the cursor is not the front Node, insert the new Node
-        // into the List before the cursor Node
-        } else if(L->index > 0) {
-            Node N = newNode(data);
-            L->cursor->prev->next = N;
-            N->prev = L->cursor->prev;
-            L->cursor->prev = N;
-            N->next = L->cursor;
-            L->length++;
-            L->index++;
-        }
-
-    }
+    // Insert the new element at the position of the cursor element,
+    // which moves up one place
+    insertAt(L, L->cursor, L->offset, data);
+    L->length++;
+    L->index++;
 }
 
 void insertAfter(List L, int data) {
@@ -389,29 +568,9 @@ void insertAfter(List L, int data) {
         exit(1);
     }
 
-    if(L->length > 0) {
-
-        // If the cursor is the back Node, insert the new Node
-        // into the the back of the List, so the new Node now becomes the back Node
-        if(L->index == L->length-1) {
-            Node N = newNode(data);
-            L->cursor->next = N;
-            N->prev = L->cursor;
-            L->back = N;
-            L->length++;
-
-        // If the cursor is not the back Node, insert the new Node
-        // into the List after the cursor Node
-        } else if(L->index >= 0) {
-            Node N = newNode(data);
-            L->cursor->next->prev = N;
-            N->next = L->cursor->next;
-            L->cursor->next = N;
-            N->prev = L->cursor;
-            L->length++;
-        }
-
-    }
+    // Insert the new element right after the cursor element
+    insertAt(L, L->cursor, L->offset+1, data);
+    L->length++;
 }
 
 void deleteFront(List L) {
@@ -427,32 +586,18 @@ void deleteFront(List L) {
         exit(1);
     }
 
-    if(L->length > 0) {
-        Node N = L->front;
-        // Check if there is more than 1 Node in the List
-        if(L->length > 1) {
-            // If the cursor is the front Node, then delete it
-            if(L->cursor == L->front) {
-                L->cursor = NULL;
-                L->index = -1;
-            // If the cursor is not the front Node, the index of the cursor
-            // will decrease by 1 because we are deleting the front Node
-            } else if(L->cursor != NULL) {
-                L->index--;
-            }
-            // Delete the front Node
-            L->front = L->front->next;
-            L->front->prev = NULL;
-        // If there is only 1 Node in the List, then delete it
-        } else {
-            L->front = L->back = L->cursor = NULL;
-            L->index = -1;
-        }
-
-        L->length--;
-        freeNode(&N);
-
+    // If the cursor is the front element, it becomes undefined, otherwise
+    // its index will decrease by 1 because we are deleting the front element
+    if(L->index == 0) {
+        L->cursor = NULL;
+        L->index = -1;
+    } else if(L->index > 0) {
+        L->index--;
     }
+
+    // Delete the front element
+    removeAt(L, L->front, 0);
+    L->length--;
 }
 
 void deleteBack(List L) {
@@ -468,27 +613,15 @@ void deleteBack(List L) {
         exit(1);
     }
 
-    if(L->length > 0) {
-        Node N = L->back;
-        // Check if the List has more than 1 Node
-        if(L->length > 1) {
-            // If the cursor is the back Node, then delete it
-            if(L->cursor == L->back) {
-                L->cursor = NULL;
-                L->index = -1;
-            }
-            // Delete the back Node
-            L->back = L->back->prev;
-            L->back->next = NULL;
-        // If there is only 1 Node in the List, then delete it
-        } else {
-            L->front = L->back = L->cursor = NULL;
-            L->index = -1;
-        }
-
-        L->length--;
-        freeNode(&N);
+    // If the cursor is the back element, it becomes undefined
+    if(L->index == L->length-1) {
+        L->cursor = NULL;
+        L->index = -1;
     }
+
+    // Delete the back element
+    removeAt(L, L->back, L->back->count-1);
+    L->length--;
 }
 
 void delete(List L) {
@@ -504,31 +637,92 @@ void delete(List L) {
         exit(1);
     }
 
-    if(L->length > 0) {
-        Node N = L->cursor;
-        // If there is only 1 Node in the List, then delete it
-        if(L->length == 1){
-            L->front = L->back = L->cursor = NULL;
-        // If the cursor is the front Node, then delete it
-        } else if(L->index == 0) {
-            L->cursor = NULL;
-            L->front = L->front->next;
-            L->front->prev = NULL;
-        // If the cursor is the back Node, then delete it
-        } else if(L->index == L->length-1) {
-            L->cursor = NULL;
-            L->back = L->back->prev;
-            L->back->next = NULL;
-        // If the cursor is not the front or back Node, then delete it
+    // The cursor becomes undefined, then its element is deleted
+    Node N = L->cursor;
+    L->cursor = NULL;
+    L->index = -1;
+    removeAt(L, N, L->offset);
+    L->length--;
+}
+
+void appendArray(List L, const int* A, int n) {
+
+    // Check if the List is NULL
+    if(L == NULL) {
+        printf("List Error: calling appendArray() on NULL List reference\n");
+        exit(1);
+    }
+
+    // Fill up the back Node, then add full Nodes after it
+    while(n > 0) {
+        if(L->back==NULL || L->back->count==BLOCK) {
+            linkAfter(L, L->back, newNode());
+        }
+        Node N = L->back;
+        int run = BLOCK - N->count;
+        if(n < run) {
+            run = n;
+        }
+        memcpy(N->data + N->count, A, run * sizeof(int));
+        N->count += run;
+        L->length += run;
+        A += run;
+        n -= run;
+    }
+}
+
+void splice(List A, List B) {
+
+    // Check if either of the Lists inputted are NULL
+    if(A==NULL || B==NULL) {
+        printf("List Error: calling splice() on NULL List reference\n");
+        exit(1);
+    }
+    // Check that the Lists are different
+    if(A == B) {
+        printf("List Error: splice() called on the same List twice");
+        exit(1);
+    }
+
+    // Link the Nodes of B after those of A
+    if(B->length > 0) {
+        if(A->length > 0) {
+            A->back->next = B->front;
+            B->front->prev = A->back;
         } else {
-            L->cursor->prev->next = L->cursor->next;
-            L->cursor->next->prev = L->cursor->prev;
-            L->cursor = NULL;
+            A->front = B->front;
         }
+        A->back = B->back;
+        A->length += B->length;
+    }
+    chargeNodes(A, B->nodes);
+    chargeNodes(B, -B->nodes);
 
-        L->index = -1;
-        L->length--;
-        freeNode(&N);
+    // B is left empty
+    B->front = B->back = B->cursor = NULL;
+    B->offset = 0;
+    B->length = 0;
+    B->index = -1;
+}
+
+// Charges the bytes this List holds, now and as it grows and shrinks until
+// it is freed, to *counter, which several Lists may share, and takes them
+// off the counter it was charged to before, if any. A NULL counter stops
+// the charging.
+void setListCounter(List L, long* counter) {
+
+    // Check if the List is NULL
+    if( L==NULL ) {
+        printf("List Error: calling setListCounter() on NULL List reference\n");
+        exit(1);
+    }
+
+    if(L->counter != NULL) {
+        *L->counter -= listBytes(L);
+    }
+    L->counter = counter;
+    if(L->counter != NULL) {
+        *L->counter += listBytes(L);
     }
 }
 
@@ -545,14 +739,16 @@ void printList(FILE* out, List L){
 
     // Print each element in the List to the file pointed to by out
     for(N = L->front; N != NULL; N = N->next){
-        fprintf(out, "%d", N->data);
-        if(N->next != NULL) {
-            fprintf(out, " ");
+        for(int i=0; i<N->count; i++) {
+            fprintf(out, "%d", N->data[i]);
+            if(i<N->count-1 || N->next != NULL) {
+                fprintf(out, " ");
+            }
         }
     }
 }
 
-// Returns a new List representing the same integer sequence as this 
+// Returns a new List representing the same integer sequence as this
 // List. The cursor in the new list is undefined, regardless of the
 // state of the cursor in this List. This List is unchanged.
 List copyList(List L) {
@@ -565,10 +761,31 @@ List copyList(List L) {
     List M = newList();
     Node N = L->front;
 
+    // Copy the elements a block at a time into full Nodes
     while(N != NULL){
-        append(M,N->data);
+        appendArray(M,N->data,N->count);
         N = N->next;
     }
 
     return M;
-}
\ No newline at end of file
+}
+
+// Copies the elements of this List, front to back, into the array A,
+// which must have room for length(L) of them, and returns how many
+// were copied. This List is unchanged.
+int toArray(List L, int* A) {
+
+    // Check if the list is NULL
+    if( L==NULL ){
+      printf("List Error: calling toArray() on NULL List reference\n");
+      exit(1);
+    }
+
+    // Copy the elements a block at a time
+    for(Node N = L->front; N != NULL; N = N->next) {
+        memcpy(A, N->data, N->count * sizeof(int));
+        A += N->count;
+    }
+
+    return(L->length);
+}
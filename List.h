@@ -39,6 +39,9 @@ int get(List L);
 // Returns true (1) if the Lists are identical, false (0) otherwise
 int equals(List A, List B);
 
+// Returns the number of bytes of heap memory this List holds
+long listBytes(List L);
+
 // Manipulation procedures ----------------------------------------------------
 
 // Empties this List and sets it back to its default state
@@ -85,6 +88,21 @@ void deleteBack(List L);
 // Deletes the cursor Node, making the cursor undefined
 void delete(List L);
 
+// Inserts the n elements of array A into this List, in order, after the
+// back element. Copies them a block at a time.
+void appendArray(List L, const int* A, int n);
+
+// Moves all elements of List B onto the back of List A in constant time,
+// leaving B empty. The cursor of A is unchanged, and that of B becomes
+// undefined. A and B must be different Lists.
+void splice(List A, List B);
+
+// Charges the bytes this List holds, now and as it grows and shrinks until
+// it is freed, to *counter, which several Lists may share, and takes them
+// off the counter it was charged to before, if any. A NULL counter stops
+// the charging.
+void setListCounter(List L, long* counter);
+
 // Other operations -----------------------------------------------------------
 
 // Prints all elements in this List out to the output file on a single line
@@ -95,4 +113,9 @@ void printList(FILE* out, List L);
 // state of the cursor in this List. This List is unchanged.
 List copyList(List L);
 
+// Copies the elements of this List, front to back, into the array A,
+// which must have room for length(L) of them, and returns how many
+// were copied. This List is unchanged.
+int toArray(List L, int* A);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,262 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <numa.h>
+#include "Memory.h"
+
+// Size of a huge page on the platforms we run on
+#define HUGE_PAGE (2UL << 20)
+
+// Most pages sampled when reporting the placement of an array
+#define PLACEMENT_SAMPLES 4096
+
+// structs --------------------------------------------------------------------
+
+// Private BlockObj type
+// Header stored just in front of every array returned by newArray(),
+// recording how the array was allocated so freeArray() can undo it.
+// It is padded to a cache line so the array itself stays aligned.
+typedef union BlockObj {
+    struct {
+        // Number of bytes asked for
+        size_t bytes;
+        // Number of bytes mapped with mmap(), or 0 if malloc() was used
+        size_t mapped;
+        // The policy the array was allocated with
+        int policy;
+        // True (1) if the array is backed by reserved huge pages
+        int reserved;
+    } info;
+    char pad[64];
+} BlockObj;
+
+// Constructors-Destructors ---------------------------------------------------
+
+// Returns a new uninitialized array of the given number of bytes,
+// allocated according to policy
+void* newArray(size_t bytes, int policy) {
+
+    BlockObj* B;
+    size_t total = bytes + sizeof(BlockObj);
+
+    if(policy == ALLOC_DEFAULT) {
+        // Plain arrays come from malloc()
+        B = malloc(total);
+        if(B == NULL) {
+            return NULL;
+        }
+        B->info.mapped = 0;
+        B->info.reserved = 0;
+    } else {
+        // Map whole huge pages if the array is to be backed by them, and
+        // whole ordinary pages otherwise, so small arrays stay small
+        size_t mapped = arrayFootprint(bytes, policy);
+        int flags = MAP_ANONYMOUS | ((policy & ALLOC_SHARED) ? MAP_SHARED : MAP_PRIVATE);
+        void* p = MAP_FAILED;
+        int reserved = 0;
+
+        // Try the system's reserved huge pages first
+        if(policy & ALLOC_HUGEPAGES) {
+            p = mmap(NULL, mapped, PROT_READ|PROT_WRITE, flags|MAP_HUGETLB, -1, 0);
+            reserved = (p != MAP_FAILED);
+        }
+
+        // Otherwise use ordinary pages, asking for transparent huge pages
+        if(p == MAP_FAILED) {
+            p = mmap(NULL, mapped, PROT_READ|PROT_WRITE, flags, -1, 0);
+            if(p == MAP_FAILED) {
+                return NULL;
+            }
+            if(policy & ALLOC_HUGEPAGES) {
+                madvise(p, mapped, MADV_HUGEPAGE);
+            }
+        }
+
+        // Set the interleave policy before any page is touched, since
+        // pages are placed on a node when they are first written
+        if((policy & ALLOC_INTERLEAVE) && numa_available() >= 0) {
+            numa_interleave_memory(p, mapped, numa_all_nodes_ptr);
+        }
+
+        B = p;
+        B->info.mapped = mapped;
+        B->info.reserved = reserved;
+    }
+
+    B->info.bytes = bytes;
+    B->info.policy = policy;
+
+    return(B + 1);
+}
+
+// Frees an array returned by newArray(). Does nothing if p is NULL.
+void freeArray(void* p) {
+
+    if(p != NULL) {
+        BlockObj* B = (BlockObj*)p - 1;
+        if(B->info.mapped > 0) {
+            munmap(B, B->info.mapped);
+        } else {
+            free(B);
+        }
+    }
+
+}
+
+// Returns the number of bytes the array p, returned by newArray(), takes
+// from the heap or the address space: the bytes asked for and its header,
+// or the whole mapping if it was mapped. Returns 0 if p is NULL.
+size_t arrayBytes(void* p) {
+
+    if(p == NULL) {
+        return 0;
+    }
+    BlockObj* B = (BlockObj*)p - 1;
+    return(B->info.mapped > 0 ? B->info.mapped : B->info.bytes + sizeof(BlockObj));
+}
+
+// Returns the number of bytes arrayBytes() reports for an array of the
+// given number of bytes allocated by newArray() according to policy, so
+// that its cost can be known before it is allocated
+size_t arrayFootprint(size_t bytes, int policy) {
+
+    size_t total = bytes + sizeof(BlockObj);
+    if(policy == ALLOC_DEFAULT) {
+        return total;
+    }
+    size_t page = (policy & ALLOC_HUGEPAGES) ? HUGE_PAGE : (size_t)sysconf(_SC_PAGESIZE);
+    return((total + page - 1) / page * page);
+}
+
+// Maps the whole file at path into memory, read-only, and returns its
+// address, storing its length in *bytes. Returns NULL if the file can't
+// be opened or mapped, or is empty.
+const void* mapFile(char* path, size_t* bytes) {
+
+    struct stat st;
+    void* p = MAP_FAILED;
+    int fd = open(path, O_RDONLY);
+
+    if(fd < 0) {
+        return NULL;
+    }
+    if(fstat(fd, &st)==0 && st.st_size>0) {
+        p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    // The mapping stays valid after the file is closed
+    close(fd);
+
+    if(p == MAP_FAILED) {
+        return NULL;
+    }
+    *bytes = st.st_size;
+    return p;
+}
+
+// Unmaps a file mapped by mapFile(), given its length. Does nothing if
+// p is NULL.
+void unmapFile(const void* p, size_t bytes) {
+    if(p != NULL) {
+        munmap((void*)p, bytes);
+    }
+}
+
+// Other operations -----------------------------------------------------------
+
+// Returns the number of kilobytes of transparent huge pages backing
+// the mapping that contains address p, according to /proc/self/smaps
+static long hugeKilobytes(void* p) {
+
+    FILE* in = fopen("/proc/self/smaps", "r");
+    char line[256];
+    unsigned long lo, hi;
+    long kb = 0;
+    int inside = 0;
+
+    if(in == NULL) {
+        return 0;
+    }
+
+    while(fgets(line, sizeof(line), in) != NULL) {
+        // Mapping headers start with the address range
+        if(sscanf(line, "%lx-%lx ", &lo, &hi) == 2 && strchr(line, '-') < strchr(line, ' ')) {
+            inside = (lo <= (unsigned long)p && (unsigned long)p < hi);
+        } else if(inside && sscanf(line, "AnonHugePages: %ld kB", &kb) == 1) {
+            break;
+        }
+    }
+
+    fclose(in);
+    return kb;
+}
+
+// Prints one line to out describing where the pages of the array p
+// (returned by newArray()) currently live: how many are on each NUMA
+// node, how many aren't backed by memory yet, and how much of the
+// array is backed by huge pages.
+void printArrayPlacement(FILE* out, char* name, void* p) {
+
+    if(p == NULL) {
+        fprintf(out, "%s: not allocated\n", name);
+        return;
+    }
+
+    BlockObj* B = (BlockObj*)p - 1;
+    int policy = B->info.policy;
+
+    fprintf(out, "%s: %zu bytes, %s%s%s%s", name, B->info.bytes,
+            policy==ALLOC_DEFAULT ? "default" : "",
+            (policy & ALLOC_HUGEPAGES) ? "huge pages" : "",
+            (policy & ALLOC_INTERLEAVE) ? ((policy & ALLOC_HUGEPAGES) ? ", interleaved" : "interleaved") : "",
+            (policy & ALLOC_SHARED) ? ((policy & ~ALLOC_SHARED) ? ", shared" : "shared") : "");
+
+    if(numa_available() < 0) {
+        fprintf(out, "; NUMA not available\n");
+        return;
+    }
+
+    // Sample evenly spaced pages and ask the kernel which node each is on
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t pages = (B->info.bytes + page - 1) / page;
+    size_t step = pages>PLACEMENT_SAMPLES ? (pages + PLACEMENT_SAMPLES - 1) / PLACEMENT_SAMPLES : 1;
+    int count = 0;
+    void* addr[PLACEMENT_SAMPLES];
+    int status[PLACEMENT_SAMPLES];
+    for(size_t i=0; i<pages; i+=step) {
+        addr[count++] = (char*)p + i*page;
+    }
+
+    int nodes = numa_max_node() + 1;
+    long* onNode = calloc(nodes, sizeof(long));
+    long absent = 0;
+    if(count>0 && numa_move_pages(0, count, addr, NULL, status, 0) == 0) {
+        for(int i=0; i<count; i++) {
+            if(status[i]>=0 && status[i]<nodes) {
+                onNode[status[i]]++;
+            } else {
+                absent++;
+            }
+        }
+    }
+
+    fprintf(out, "; %d pages sampled:", count);
+    for(int i=0; i<nodes; i++) {
+        fprintf(out, " node %d: %ld", i, onNode[i]);
+    }
+    fprintf(out, ", untouched: %ld", absent);
+    free(onNode);
+
+    // Report huge page backing
+    if(B->info.reserved) {
+        fprintf(out, "; reserved huge pages\n");
+    } else if(B->info.mapped > 0) {
+        fprintf(out, "; %ld kB of its mapping in transparent huge pages\n", hugeKilobytes(B));
+    } else {
+        fprintf(out, "\n");
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef _MEMORY_H_INCLUDE_
+#define _MEMORY_H_INCLUDE_
+#include <stdio.h>
+#include <stdlib.h>
+
+// Allocation policies for large arrays, which may be combined with |.
+// ALLOC_HUGEPAGES backs the array with huge pages, either reserved ones
+// if the system has any to spare or transparent ones otherwise, which
+// cuts TLB misses when BFS jumps around a large array.
+// ALLOC_INTERLEAVE spreads the pages of the array round-robin over all
+// NUMA nodes, so that threads on every socket share the memory traffic.
+// ALLOC_SHARED maps the array so that it stays shared with any process
+// forked after it is allocated, rather than being copied on write.
+#define ALLOC_DEFAULT 0
+#define ALLOC_HUGEPAGES 1
+#define ALLOC_INTERLEAVE 2
+#define ALLOC_SHARED 4
+
+// Returns a new uninitialized array of the given number of bytes,
+// allocated according to policy
+void* newArray(size_t bytes, int policy);
+
+// Frees an array returned by newArray(). Does nothing if p is NULL.
+void freeArray(void* p);
+
+// Returns the number of bytes the array p, returned by newArray(), takes
+// from the heap or the address space: the bytes asked for and its header,
+// or the whole mapping if it was mapped. Returns 0 if p is NULL.
+size_t arrayBytes(void* p);
+
+// Returns the number of bytes arrayBytes() reports for an array of the
+// given number of bytes allocated by newArray() according to policy, so
+// that its cost can be known before it is allocated
+size_t arrayFootprint(size_t bytes, int policy);
+
+// Maps the whole file at path into memory, read-only, and returns its
+// address, storing its length in *bytes. Returns NULL if the file can't
+// be opened or mapped, or is empty.
+const void* mapFile(char* path, size_t* bytes);
+
+// Unmaps a file mapped by mapFile(), given its length. Does nothing if
+// p is NULL.
+void unmapFile(const void* p, size_t bytes);
+
+// Prints one line to out describing where the pages of the array p
+// (returned by newArray()) currently live: how many are on each NUMA
+// node, how many aren't backed by memory yet, and how much of the
+// array is backed by huge pages.
+void printArrayPlacement(FILE* out, char* name, void* p);
+
+#endif
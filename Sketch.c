@@ -0,0 +1,346 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "Sketch.h"
+
+// Stored distance of a vertex a landmark doesn't reach, or that doesn't
+// reach the landmark
+#define UNREACHED 0xFFFF
+
+// Stored distance of a vertex too far from the landmark to store
+#define FAR 0xFFFE
+
+// structs --------------------------------------------------------------------
+
+// Private SketchObj type
+// The distances between every vertex and each landmark. The k distances of
+// vertex v start at index v*k, so one query reads them all at once.
+typedef struct SketchObj {
+    Graph graph;
+    int order;
+    int size;
+    int* landmark;
+    // Distance from each landmark to each vertex, and from each vertex to
+    // each landmark, which is the same array for an undirected Graph
+    uint16_t* from;
+    uint16_t* to;
+} SketchObj;
+
+// Private Job type
+// The landmarks shared by the threads of one call to newSketch(), which
+// each take the next landmark not searched yet
+typedef struct Job {
+    Sketch sketch;
+    int next;
+    pthread_mutex_t lock;
+} Job;
+
+// Private Degree type
+// A vertex and its degree, for picking landmarks
+typedef struct Degree {
+    int vertex;
+    int degree;
+} Degree;
+
+// Private helpers ------------------------------------------------------------
+
+// Orders vertices by decreasing degree, and by label among equals
+static int byDegree(const void* a, const void* b) {
+    const Degree* x = a;
+    const Degree* y = b;
+    if(x->degree != y->degree) {
+        return((y->degree > x->degree) - (y->degree < x->degree));
+    }
+    return((x->vertex > y->vertex) - (x->vertex < y->vertex));
+}
+
+// Stores the distances of the last search of S as landmark i of column D
+static void storeColumn(Sketch K, uint16_t* D, int i, Search S) {
+    for(int v=1; v<K->order+1; v++) {
+        int d = searchDist(S, v);
+        D[(long)v*K->size + i] = d==INF ? UNREACHED : d<FAR ? d : FAR;
+    }
+}
+
+// Body of each thread: searches from landmarks until there are none left,
+// forwards and, for a directed Graph, backwards
+static void* workerMain(void* arg) {
+
+    Job* J = arg;
+    Sketch K = J->sketch;
+    Search S = newSearch(K->graph);
+
+    while(1) {
+        pthread_mutex_lock(&J->lock);
+        int i = J->next++;
+        pthread_mutex_unlock(&J->lock);
+        if(i >= K->size) {
+            break;
+        }
+        searchBFS(S, K->landmark[i]);
+        storeColumn(K, K->from, i, S);
+        if(K->to != K->from) {
+            searchReverse(S, K->landmark[i]);
+            storeColumn(K, K->to, i, S);
+        }
+    }
+
+    freeSearch(&S);
+    return NULL;
+}
+
+// Constructors-Destructors ---------------------------------------------------
+
+// Returns a sketch of the distances in G, which must not change while it is
+// in use, built by a BFS from each of k landmarks, the vertices of greatest
+// degree (or every vertex if G has fewer than k). The searches are spread
+// over the given number of threads. Every vertex keeps its distance from
+// and to each landmark in 2 bytes, all together, so a query only reads two
+// short runs of memory. Distances count edges, not weights.
+Sketch newSketch(Graph G, int k, int threads) {
+
+    // Check if the Graph is NULL
+    if(G == NULL) {
+        printf("Sketch Error: calling newSketch() on NULL Graph reference\n");
+        exit(1);
+    }
+
+    // Make sure there is at least one landmark
+    if(k < 1) {
+        printf("Sketch Error: newSketch() called with no landmarks\n");
+        exit(1);
+    }
+
+    int n = getOrder(G);
+    const int* adj;
+    Sketch K = newGraphArray(G, MEMORY_VERTEX, 1, sizeof(SketchObj));
+    K->graph = G;
+    K->order = n;
+    K->size = k<n ? k : n;
+    if(threads < 1) {
+        threads = 1;
+    }
+
+    // Take the vertices of greatest degree as landmarks
+    Search S = newSearch(G);
+    Degree* D = newGraphArray(G, MEMORY_SCRATCH, n, sizeof(Degree));
+    for(int v=1; v<n+1; v++) {
+        D[v-1].vertex = v;
+        D[v-1].degree = searchNeighbors(S, v, &adj);
+    }
+    qsort(D, n, sizeof(Degree), byDegree);
+    K->landmark = newGraphArray(G, MEMORY_VERTEX, K->size, sizeof(int));
+    for(int i=0; i<K->size; i++) {
+        K->landmark[i] = D[i].vertex;
+    }
+    freeGraphArray(G, MEMORY_SCRATCH, D);
+    freeSearch(&S);
+
+    K->from = newGraphArray(G, MEMORY_VERTEX, (long)(n+1) * K->size, sizeof(uint16_t));
+    K->to = isDirected(G) ? newGraphArray(G, MEMORY_VERTEX, (long)(n+1) * K->size, sizeof(uint16_t)) : K->from;
+
+    // Search from every landmark on the threads
+    Job J;
+    J.sketch = K;
+    J.next = 0;
+    pthread_mutex_init(&J.lock, NULL);
+    pthread_t* thread = newGraphArray(G, MEMORY_SCRATCH, threads, sizeof(pthread_t));
+    for(int t=0; t<threads; t++) {
+        if(pthread_create(&thread[t], NULL, workerMain, &J) != 0) {
+            printf("Sketch Error: unable to start thread %d\n", t);
+            exit(1);
+        }
+    }
+    for(int t=0; t<threads; t++) {
+        pthread_join(thread[t], NULL);
+    }
+    freeGraphArray(G, MEMORY_SCRATCH, thread);
+    pthread_mutex_destroy(&J.lock);
+
+    return(K);
+}
+
+// Frees all heap memory associated with *pK, and sets *pK to NULL. Must
+// come before the Graph is freed, which counts the memory of the sketch.
+void freeSketch(Sketch* pK) {
+
+    if(pK!=NULL && *pK!=NULL) {
+        Graph G = (*pK)->graph;
+        if((*pK)->to != (*pK)->from) {
+            freeGraphArray(G, MEMORY_VERTEX, (*pK)->to);
+        }
+        freeGraphArray(G, MEMORY_VERTEX, (*pK)->from);
+        freeGraphArray(G, MEMORY_VERTEX, (*pK)->landmark);
+        freeGraphArray(G, MEMORY_VERTEX, *pK);
+        *pK = NULL;
+    }
+}
+
+// Access functions -----------------------------------------------------------
+
+// Returns the number of landmarks of this sketch
+int sketchSize(Sketch K) {
+
+    // Check if this Sketch is NULL
+    if(K == NULL) {
+        printf("Sketch Error: calling sketchSize() on NULL Sketch reference\n");
+        exit(1);
+    }
+
+    return(K->size);
+}
+
+// Returns landmark i of this sketch, for i from 0 to sketchSize(K)-1
+int sketchLandmark(Sketch K, int i) {
+
+    // Check if this Sketch is NULL
+    if(K == NULL) {
+        printf("Sketch Error: calling sketchLandmark() on NULL Sketch reference\n");
+        exit(1);
+    }
+
+    // Make sure there is such a landmark
+    if(i<0 || i>=K->size) {
+        printf("Sketch Error: sketchLandmark() called on improper index\n");
+        exit(1);
+    }
+
+    return(K->landmark[i]);
+}
+
+// Sets *lower and *upper to bounds on the distance from u to v found from
+// the landmarks alone, in time proportional to their number. The upper bound
+// is INF if no landmark lies on a path from u to v, and both are INF if
+// some landmark shows there is no such path. Returns true (1) if the bounds
+// are equal, and so give the distance exactly, otherwise false (0).
+int sketchBounds(Sketch K, int u, int v, int* lower, int* upper) {
+
+    // Check if this Sketch is NULL
+    if(K == NULL) {
+        printf("Sketch Error: calling sketchBounds() on NULL Sketch reference\n");
+        exit(1);
+    }
+
+    // Checks if u and v are valid vertices
+    if(u<1 || u>K->order || v<1 || v>K->order) {
+        printf("Sketch Error: sketchBounds() called on improper vertex\n");
+        exit(1);
+    }
+
+    if(u == v) {
+        *lower = *upper = 0;
+        return(1);
+    }
+
+    int k = K->size;
+    const uint16_t* fromU = &K->from[(long)u*k];
+    const uint16_t* fromV = &K->from[(long)v*k];
+    const uint16_t* toU = &K->to[(long)u*k];
+    const uint16_t* toV = &K->to[(long)v*k];
+    int lo = 1, hi = 2*FAR;
+
+    for(int i=0; i<k; i++) {
+        int a = fromU[i], b = fromV[i], c = toU[i], d = toV[i];
+
+        // Whatever reaches u reaches v, and whatever v reaches u reaches,
+        // if there is a path from u to v
+        if((a!=UNREACHED && b==UNREACHED) || (d!=UNREACHED && c==UNREACHED)) {
+            *lower = *upper = INF;
+            return(1);
+        }
+
+        // The path through the landmark is at least as long as the shortest,
+        // and by the triangle inequality the shortest makes up the
+        // difference between the distances of u and v from the landmark
+        if(c<FAR && b<FAR && c+b<hi) {
+            hi = c+b;
+        }
+        if(a<FAR && b<FAR && b-a>lo) {
+            lo = b-a;
+        }
+        if(c<FAR && d<FAR && c-d>lo) {
+            lo = c-d;
+        }
+    }
+
+    *lower = lo;
+    *upper = hi<2*FAR ? hi : INF;
+    return(lo == hi);
+}
+
+// If the bounds on the distance from u to v are equal, appends to L a
+// shortest u-v path through a landmark and returns the distance, or
+// appends NIL and returns INF if the landmarks show there is no path.
+// Otherwise leaves L unchanged and returns SKETCH_UNKNOWN. The path is
+// found by walking the distances to and from the landmark down through
+// the adjacency lists read with the Search S, which must be a Search over
+// the Graph of this sketch.
+int sketchPath(Sketch K, Search S, int u, int v, List L) {
+
+    // Check if this Sketch is NULL
+    if(K == NULL) {
+        printf("Sketch Error: calling sketchPath() on NULL Sketch reference\n");
+        exit(1);
+    }
+
+    int lower, upper;
+    if(!sketchBounds(K, u, v, &lower, &upper)) {
+        return(SKETCH_UNKNOWN);
+    }
+    if(upper == INF) {
+        append(L, NIL);
+        return(INF);
+    }
+    if(upper == 0) {
+        append(L, u);
+        return(0);
+    }
+
+    // Find the landmark the shortest path runs through
+    int k = K->size;
+    int i = 0;
+    while(K->to[(long)u*k+i]>=FAR || K->from[(long)v*k+i]>=FAR
+          || K->to[(long)u*k+i] + K->from[(long)v*k+i] != upper) {
+        i++;
+    }
+
+    int* P = newGraphArray(K->graph, MEMORY_SCRATCH, upper+1, sizeof(int));
+    const int* adj;
+
+    // Walk from u to the landmark, each step to a neighbor one closer to it,
+    int x = u;
+    int pos = 0;
+    P[pos] = x;
+    while(K->to[(long)x*k+i] != 0) {
+        int want = K->to[(long)x*k+i] - 1;
+        int deg = searchNeighbors(S, x, &adj);
+        for(int j=0; j<deg; j++) {
+            if(K->to[(long)adj[j]*k+i] == want) {
+                x = adj[j];
+                break;
+            }
+        }
+        P[++pos] = x;
+    }
+
+    // and back from v to the landmark, each step to an in-neighbor one
+    // closer to the landmark, filling in the path from its end
+    x = v;
+    pos = upper;
+    while(K->from[(long)x*k+i] != 0) {
+        P[pos--] = x;
+        int want = K->from[(long)x*k+i] - 1;
+        int deg = searchInNeighbors(S, x, &adj);
+        for(int j=0; j<deg; j++) {
+            if(K->from[(long)adj[j]*k+i] == want) {
+                x = adj[j];
+                break;
+            }
+        }
+    }
+
+    appendArray(L, P, upper+1);
+    freeGraphArray(K->graph, MEMORY_SCRATCH, P);
+    return(upper);
+}
@@ -0,0 +1,50 @@
+#ifndef _SKETCH_H_INCLUDE_
+#define _SKETCH_H_INCLUDE_
+#include "Graph.h"
+
+// Returned by sketchPath() when the landmarks don't pin the distance down
+#define SKETCH_UNKNOWN -2
+
+// Exported type --------------------------------------------------------------
+typedef struct SketchObj* Sketch;
+
+
+// Constructors-Destructors ---------------------------------------------------
+
+// Returns a sketch of the distances in G, which must not change while it is
+// in use, built by a BFS from each of k landmarks, the vertices of greatest
+// degree (or every vertex if G has fewer than k). The searches are spread
+// over the given number of threads. Every vertex keeps its distance from
+// and to each landmark in 2 bytes, all together, so a query only reads two
+// short runs of memory. Distances count edges, not weights.
+Sketch newSketch(Graph G, int k, int threads);
+
+// Frees all heap memory associated with *pK, and sets *pK to NULL. Must
+// come before the Graph is freed, which counts the memory of the sketch.
+void freeSketch(Sketch* pK);
+
+// Access functions -----------------------------------------------------------
+
+// Returns the number of landmarks of this sketch
+int sketchSize(Sketch K);
+
+// Returns landmark i of this sketch, for i from 0 to sketchSize(K)-1
+int sketchLandmark(Sketch K, int i);
+
+// Sets *lower and *upper to bounds on the distance from u to v found from
+// the landmarks alone, in time proportional to their number. The upper bound
+// is INF if no landmark lies on a path from u to v, and both are INF if
+// some landmark shows there is no such path. Returns true (1) if the bounds
+// are equal, and so give the distance exactly, otherwise false (0).
+int sketchBounds(Sketch K, int u, int v, int* lower, int* upper);
+
+// If the bounds on the distance from u to v are equal, appends to L a
+// shortest u-v path through a landmark and returns the distance, or
+// appends NIL and returns INF if the landmarks show there is no path.
+// Otherwise leaves L unchanged and returns SKETCH_UNKNOWN. The path is
+// found by walking the distances to and from the landmark down through
+// the adjacency lists read with the Search S, which must be a Search over
+// the Graph of this sketch.
+int sketchPath(Sketch K, Search S, int u, int v, List L);
+
+#endif